@@ -4,32 +4,41 @@
 
 import PIL.Image
 import PIL.ImageOps
+import PIL.ImageChops
 import os
 import io
+import enum
 import struct
 import requests
 from .base import Resource, findFile, fstrSize, StructSize, PixelFormat
+from common import InputError
 
 class Image(Resource):
+    class Flag(enum.IntEnum):
+        alpha = 0x01
+        premultiplied = 0x02
+
     def __init__(self):
         super().__init__()
         self.bitmap = None
         self.width = None
         self.height = None
         self.format = None
+        self.flags = 0
         self.headerSize = 0
 
     def serialize(self, bmOffset, res_offset, ptr64: bool):
         """struct ImageResource"""
         fmt = PixelFormat[self.format.upper()].value
         print(f'image {self.name} format {self.format} {fmt}')
-        return struct.pack('<QIIHHI' if ptr64 else '<IIIHHI',
+        return struct.pack('<QIIHHBBxx' if ptr64 else '<IIIHHBBxx',
             0, # FSTR::String* name
             bmOffset,
             len(self.bitmap),
             self.width,
             self.height,
-            fmt)
+            fmt,
+            self.flags)
 
     def get_bitmap_size(self):
         return len(self.bitmap)
@@ -46,6 +55,7 @@ class Image(Resource):
         out.write("\t.width = %u,\n" % self.width)
         out.write("\t.height = %u,\n" % self.height)
         out.write("\t.format = PixelFormat::%s,\n" % self.format)
+        out.write("\t.flags = 0x%02x,\n" % self.flags)
         out.write("};\n\n")
         self.headerSize += StructSize.Image
         return bmOffset + self.get_bitmap_size()
@@ -79,6 +89,37 @@ def convert_rgb565(image, source):
     return data
 
 
+def convert_bgra32(image, source):
+    """32-bit pixels with alpha channel in last byte"""
+    image.format = 'BGRA32'
+    image.flags |= Image.Flag.alpha
+    data = bytearray(image.width * image.height * 4)
+    i = 0
+    for p in source.convert('RGBA').getdata():
+        data[i+0] = p[2]
+        data[i+1] = p[1]
+        data[i+2] = p[0]
+        data[i+3] = p[3]
+        i += 4
+    return data
+
+
+def convert_rgb565a8(image, source):
+    """RGB565 pixels, each followed by an 8-bit alpha value"""
+    image.format = 'RGB565'
+    image.flags |= Image.Flag.alpha
+    data = bytearray(image.width * image.height * 3)
+    i = 0
+    for p in source.convert('RGBA').getdata():
+        r, g, b = p[0] >> 3, p[1] >> 2, p[2] >> 3
+        color = (r << 11) | (g << 5) | b
+        data[i+0] = color >> 8
+        data[i+1] = color & 0xff
+        data[i+2] = p[3]
+        i += 3
+    return data
+
+
 def convert_bmp(image, source):
     image.format = 'None'
     bytes = io.BytesIO()
@@ -89,6 +130,8 @@ def convert_bmp(image, source):
 converters = {
     'RGB24': convert_rgb24,
     'RGB565': convert_rgb565,
+    'BGRA32': convert_bgra32,
+    'RGB565A8': convert_rgb565a8,
     'BMP': convert_bmp,
 }
 
@@ -161,6 +204,13 @@ def colorise_image(img, args):
     gimg = PIL.ImageOps.grayscale(img)
     return PIL.ImageOps.colorize(gimg, black, white, mid, blackpoint, whitepoint, midpoint)
 
+def premultiply_image(img):
+    """Multiply colour channels by alpha"""
+    img = img.convert('RGBA')
+    r, g, b, a = img.split()
+    r, g, b = (PIL.ImageChops.multiply(c, a) for c in (r, g, b))
+    return PIL.Image.merge('RGBA', (r, g, b, a))
+
 transforms = {
     'crop': crop_image,
     'resize': resize_image,
@@ -198,7 +248,14 @@ def parse_item(item, name):
     format = item.get('format')
     if format:
         convert = converters[format]
+        premultiplied = item.get('premultiplied')
+        if premultiplied:
+            img = premultiply_image(img)
         image.bitmap = convert(image, img)
+        if premultiplied:
+            if not image.flags & Image.Flag.alpha:
+                raise InputError("Image '%s': format '%s' has no alpha channel to premultiply" % (name, format))
+            image.flags |= Image.Flag.premultiplied
     else:
         image.format = 'None'
         with open(filename, 'rb') as f:
@@ -26,7 +26,7 @@ class AddressWindow:
         self.column = 0
     
     def setRow(self, y, h):
-        self.bounds.y, self.bounds.y = y, h
+        self.bounds.y, self.bounds.h = y, h
         self.initial.y, self.initial.h = y, h
         self.column = 0
 
@@ -35,6 +35,13 @@ ifeq ($(ENABLE_GRAPHICS_RAM_TRACKING),1)
 COMPONENT_CXXFLAGS += -DENABLE_GRAPHICS_RAM_TRACKING=1
 endif
 
+#
+COMPONENT_VARS += ENABLE_GRAPHICS_DL_STATS
+ENABLE_GRAPHICS_DL_STATS ?= 0
+ifeq ($(ENABLE_GRAPHICS_DL_STATS),1)
+GLOBAL_CFLAGS += -DENABLE_GRAPHICS_DL_STATS=1
+endif
+
 # Resource compiler
 RC_TOOL_CMDLINE := $(PYTHON) -X utf8 $(GRAPHICS_LIB_ROOT)/Tools/rc/rc.py
 
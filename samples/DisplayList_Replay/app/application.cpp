@@ -0,0 +1,111 @@
+#include <SmingCore.h>
+#include <Graphics.h>
+#include <Graphics/MipiDisplay.h>
+#include <Data/Stream/HostFileStream.h>
+#include <hostlib/CommandLine.h>
+
+using namespace Graphics;
+
+namespace
+{
+// Must be large enough for any recorded list, including inlined writeDataBuffer content
+constexpr size_t listSize{32768};
+
+// Shared by all read entries
+uint8_t readBuffer[0x8000];
+
+void nullCallback(void*)
+{
+}
+
+bool openCapture(HostFileStream& stream, DisplayListRecorder::Header& header)
+{
+	auto filename = commandLine.getParameters().find("capture");
+	if(!filename) {
+		Serial.println(_F("Specify recording using HOST_PARAMETERS=\"capture=FILENAME\""));
+		return false;
+	}
+	if(!stream.open(filename.getValue())) {
+		Serial << _F("Failed to open '") << filename.getValue() << '\'' << endl;
+		return false;
+	}
+	return DisplayListRecorder::readHeader(stream, header);
+}
+
+/*
+ * Feed each list through the SPI interpreter.
+ * Requests are consumed directly in place of the HSPI controller so only list processing is timed.
+ */
+void benchmark(IDataSourceStream& stream, unsigned repeats)
+{
+	AddressWindow addrWindow;
+	SpiDisplayList list(MipiDisplay::commands, addrWindow, listSize);
+
+	unsigned listCount{0};
+	unsigned requestCount{0};
+	unsigned commandCount{0};
+	uint32_t bytesOut{0};
+	uint32_t bytesIn{0};
+	uint32_t listBytes{0};
+	uint32_t elapsedUs{0};
+	OneShotFastUs timer;
+
+	while(DisplayListRecorder::load(stream, list, readBuffer, nullCallback)) {
+		++listCount;
+		listBytes += list.used();
+
+		list.prepare(nullptr, nullptr);
+		while(list.fillRequest()) {
+			auto& req = list.request;
+			++requestCount;
+			if(req.cmdLen != 0) {
+				++commandCount;
+			}
+			bytesOut += req.out.length;
+			bytesIn += req.in.length;
+		}
+
+		timer.start();
+		for(unsigned i = 0; i < repeats; ++i) {
+			list.prepare(nullptr, nullptr);
+			while(list.fillRequest()) {
+			}
+		}
+		elapsedUs += timer.elapsedTime().time;
+	}
+
+	Serial << _F("Lists:     ") << listCount << _F(", ") << listBytes << _F(" bytes") << endl;
+	Serial << _F("Requests:  ") << requestCount << _F(", ") << commandCount << _F(" commands") << endl;
+	Serial << _F("Data:      ") << bytesOut << _F(" bytes out, ") << bytesIn << _F(" bytes in") << endl;
+	Serial << _F("Time:      ") << elapsedUs << _F(" us for ") << repeats << _F(" passes") << endl;
+	if(repeats != 0 && requestCount != 0) {
+		auto perRequest = 1000.0 * elapsedUs / (double(repeats) * requestCount);
+		Serial << _F("Per request: ") << String(perRequest, 1) << _F(" ns") << endl;
+	}
+}
+
+} // namespace
+
+void init()
+{
+	Serial.begin(SERIAL_BAUD_RATE);
+	Serial.systemDebugOutput(true);
+
+	HostFileStream stream;
+	DisplayListRecorder::Header header;
+	if(!openCapture(stream, header)) {
+		System.restart();
+		return;
+	}
+
+	unsigned repeats{100};
+	auto param = commandLine.getParameters().find("repeat");
+	if(param) {
+		repeats = param.getValue().toInt();
+	}
+
+	Serial << _F("Recorded pixel format ") << toString(header.pixelFormat) << endl;
+	benchmark(stream, repeats);
+
+	System.restart();
+}
@@ -0,0 +1,5 @@
+ARDUINO_LIBRARIES := Graphics
+DISABLE_NETWORK := 1
+
+# Replays captures from the host filesystem
+COMPONENT_SOC := host
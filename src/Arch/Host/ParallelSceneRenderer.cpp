@@ -0,0 +1,361 @@
+/****
+ * ParallelSceneRenderer.cpp
+ *
+ * Copyright 2021 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the Sming-Graphics Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * @author: May 2021 - mikee47 <mike@sillyhouse.net>
+ *
+ ****/
+
+#include <Graphics/ParallelSceneRenderer.h>
+#include <hostlib/threads.h>
+#include <thread>
+
+namespace Graphics
+{
+namespace
+{
+// Serialises access to objects which share stream or other state
+CMutex sharedLock;
+
+template <class T> bool hasTexture(const Object& object)
+{
+	return static_cast<const T&>(object).brush.getKind() == Brush::Kind::Texture;
+}
+
+template <class T> bool penHasTexture(const Object& object)
+{
+	return static_cast<const T&>(object).pen.getKind() == Brush::Kind::Texture;
+}
+
+/*
+ * Determine if an object may be rendered concurrently with others.
+ *
+ * Images, fonts and drawings may read from shared streams (e.g. the resource stream)
+ * so only simple shapes with solid colours qualify.
+ */
+bool isThreadSafe(const Object& object)
+{
+	switch(object.kind()) {
+	case Object::Kind::Point:
+		return !hasTexture<PointObject>(object);
+	case Object::Kind::Rect:
+		return !penHasTexture<RectObject>(object);
+	case Object::Kind::FilledRect:
+		return !hasTexture<FilledRectObject>(object);
+	case Object::Kind::Line:
+		return !penHasTexture<LineObject>(object);
+	case Object::Kind::Polyline:
+		return !penHasTexture<PolylineObject>(object);
+	case Object::Kind::FilledPolygon:
+		return !hasTexture<FilledPolygonObject>(object);
+	case Object::Kind::Circle:
+		return !penHasTexture<CircleObject>(object);
+	case Object::Kind::FilledCircle:
+		return !hasTexture<FilledCircleObject>(object);
+	case Object::Kind::Ellipse:
+		return !penHasTexture<EllipseObject>(object);
+	case Object::Kind::FilledEllipse:
+		return !hasTexture<FilledEllipseObject>(object);
+	case Object::Kind::Arc:
+		return !penHasTexture<ArcObject>(object);
+	case Object::Kind::FilledArc:
+		return !hasTexture<FilledArcObject>(object);
+	default:
+		return false;
+	}
+}
+
+/*
+ * Determine if an object's renderer may depend on the main loop.
+ *
+ * Renderers which read display memory, such as SurfaceRenderer, complete via a callback
+ * queued with `System.queueCallback()`. That never runs on a band thread because the main
+ * loop is blocked waiting for the band to finish.
+ * Custom objects may create any renderer, so they're excluded too.
+ */
+bool needsMainLoop(const Object& object)
+{
+	switch(object.kind()) {
+	case Object::Kind::Copy:
+	case Object::Kind::Scroll:
+	case Object::Kind::Surface:
+	case Object::Kind::Recording:
+	case Object::Kind::Custom:
+		return true;
+	case Object::Kind::Reference:
+		return needsMainLoop(static_cast<const ReferenceObject&>(object).object);
+	case Object::Kind::Scene:
+		for(auto& obj : static_cast<const SceneObject&>(object).objects) {
+			if(needsMainLoop(obj)) {
+				return true;
+			}
+		}
+		return false;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+/* ParallelSceneRenderer::Band */
+
+class ParallelSceneRenderer::Band : public CThread
+{
+public:
+	Band(const SceneObject& scene, const Rect* bounds, const Rect& area, PixelFormat pixelFormat)
+		: CThread("Band", 0), scene(scene), bounds(bounds), area(area), image(pixelFormat, area.size())
+	{
+	}
+
+	~Band()
+	{
+		wait();
+	}
+
+	bool init()
+	{
+		if(!image.isValid()) {
+			return false;
+		}
+		surface.reset(image.createSurface());
+
+		// Start with the last opaque fill covering the band, if there is one
+		unsigned i{0};
+		for(auto& obj : scene.objects) {
+			if(obj.kind() == Object::Kind::FilledRect && bounds[i].contains(area)) {
+				auto& fill = static_cast<const FilledRectObject&>(obj);
+				if(fill.radius == 0 && fill.blender == nullptr && fill.brush.isSolid() &&
+				   !fill.brush.isTransparent()) {
+					firstObject = &obj;
+					firstIndex = i;
+				}
+			}
+			++i;
+		}
+		return true;
+	}
+
+	const Rect& getArea() const
+	{
+		return area;
+	}
+
+	/**
+	 * @brief Get renderer to fetch band content from display
+	 * @retval Renderer* nullptr if band is completely covered
+	 */
+	Renderer* createReadback(Point origin)
+	{
+		if(firstObject != nullptr) {
+			return nullptr;
+		}
+		return new SurfaceRenderer(Location{area.size()}, *surface, area.size(), origin + area.topLeft());
+	}
+
+	void start(const Rect& dest)
+	{
+		this->dest = dest;
+		if(firstObject == nullptr) {
+			firstObject = scene.objects.head();
+		}
+		started = CThread::execute();
+		if(!started) {
+			// Draw it ourselves
+			thread_routine();
+		}
+	}
+
+	/**
+	 * @brief Write band content to surface
+	 * @retval bool false if surface is full
+	 */
+	bool write(Surface& surface, Point origin)
+	{
+		wait();
+		if(!windowSet) {
+			if(!surface.setAddrWindow(area + origin)) {
+				return false;
+			}
+			windowSet = true;
+		}
+		auto pixelFormat = image.getPixelFormat();
+		auto bpp = getBytesPerPixel(pixelFormat);
+		Location loc;
+		while(pos.y < area.h) {
+			uint16_t available;
+			auto buf = surface.getBuffer(bpp, available);
+			if(buf == nullptr) {
+				return false;
+			}
+			uint16_t count = std::min(available / bpp, area.w - pos.x);
+			loc.pos = pos;
+			image.readPixels(loc, pixelFormat, buf, count);
+			surface.commit(count * bpp);
+			pos.x += count;
+			if(pos.x == area.w) {
+				pos.x = 0;
+				++pos.y;
+			}
+		}
+		return true;
+	}
+
+protected:
+	void* thread_routine() override
+	{
+		std::unique_ptr<Renderer> renderer;
+		unsigned i = firstIndex;
+		for(auto object = firstObject; object != nullptr; object = object->getNext(), ++i) {
+			if(!bounds[i].intersects(area)) {
+				continue;
+			}
+			bool locked = !isThreadSafe(*object);
+			if(locked) {
+				sharedLock.lock();
+			}
+			if(surface->render(*object, dest, renderer)) {
+				while(!surface->execute(renderer)) {
+					// Renderer is yielding: memory surfaces never block, and nothing here waits on callbacks
+				}
+			} else {
+				// Memory surfaces have no buffer to fill, so there's no point retrying
+				debug_e("[PARALLEL] Failed to render %s", toString(object->kind()).c_str());
+				renderer.reset();
+			}
+			if(locked) {
+				sharedLock.unlock();
+			}
+		}
+		return nullptr;
+	}
+
+private:
+	void wait()
+	{
+		if(started) {
+			join();
+			started = false;
+		}
+	}
+
+	const SceneObject& scene;
+	const Rect* bounds;
+	Rect area; ///< Band position relative to scene
+	Rect dest; ///< Scene location relative to band
+	MemoryImageObject image;
+	std::unique_ptr<Surface> surface;
+	const Object* firstObject{};
+	unsigned firstIndex{0};
+	Point pos{}; ///< Write position
+	bool started{false};
+	bool windowSet{false};
+};
+
+/* ParallelSceneRenderer */
+
+ParallelSceneRenderer::ParallelSceneRenderer(const Location& location, const SceneObject& scene,
+											 unsigned threadCount)
+	: Renderer(location), scene(scene), threadCount(threadCount ?: std::thread::hardware_concurrency())
+{
+}
+
+ParallelSceneRenderer::~ParallelSceneRenderer() = default;
+
+bool ParallelSceneRenderer::init(Surface& surface)
+{
+	auto objectCount = scene.objects.count();
+	bounds.reset(new Rect[objectCount]);
+	unsigned i{0};
+	for(auto& obj : scene.objects) {
+		if(needsMainLoop(obj)) {
+			return false;
+		}
+		// Also fills bounds cache so threads don't write to objects
+		auto r = obj.getBounds();
+		bounds[i++] = r ? r : Rect(scene.getSize());
+	}
+
+	Rect area = intersect(scene.getSize(), location.dest.size());
+	unsigned count = std::max(1U, std::min(threadCount, unsigned(area.h)));
+	auto pixelFormat = surface.getPixelFormat();
+	for(i = 0; i < count; ++i) {
+		int16_t y1 = area.y + area.h * i / count;
+		int16_t y2 = area.y + area.h * (i + 1) / count;
+		Rect r(area.x, y1, area.w, y2 - y1);
+		auto band = std::make_unique<Band>(scene, bounds.get(), r, pixelFormat);
+		if(!band->init()) {
+			bands.clear();
+			return false;
+		}
+		bands.push_back(std::move(band));
+	}
+
+	return true;
+}
+
+bool ParallelSceneRenderer::execute(Surface& surface)
+{
+	for(;;) {
+		if(!surface.execute(renderer)) {
+			return false;
+		}
+
+		switch(state) {
+		case State::init:
+			if(init(surface)) {
+				bandIndex = 0;
+				state = State::readback;
+				break;
+			}
+			debug_w("[PARALLEL] Using regular scene renderer");
+			renderer = std::make_unique<SceneRenderer>(location, scene);
+			state = State::done;
+			break;
+
+		case State::readback:
+			if(bandIndex < bands.size()) {
+				renderer.reset(bands[bandIndex++]->createReadback(location.dest.topLeft()));
+				break;
+			}
+			for(auto& band : bands) {
+				band->start(Rect(location.dest.size()) - band->getArea().topLeft());
+			}
+			bandIndex = 0;
+			state = State::write;
+			break;
+
+		case State::write:
+			if(bandIndex >= bands.size()) {
+				state = State::done;
+				break;
+			}
+			if(!bands[bandIndex]->write(surface, location.dest.topLeft())) {
+				return false;
+			}
+			++bandIndex;
+			if(surface.yieldRequired()) {
+				return false;
+			}
+			break;
+
+		case State::done:
+			return true;
+		}
+	}
+}
+
+} // namespace Graphics
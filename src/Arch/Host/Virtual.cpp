@@ -85,16 +85,9 @@ struct ReadPixelInfo {
 	{
 		// debug_i("readComplete()");
 		if(buffer.format != PixelFormat::BGR24) {
-			auto src = buffer.data.get();
-			auto dst = src;
-			for(unsigned i = 0; i < bytesToRead; i += BYTES_PER_PIXEL) {
-				PixelBuffer buf;
-				buf.bgra32.b = *src++;
-				buf.bgra32.g = *src++;
-				buf.bgra32.r = *src++;
-				dst += writeColor(dst, buf.color, buffer.format);
-			}
-			bytesToRead = dst - buffer.data.get();
+			auto ptr = &buffer.data[buffer.offset];
+			auto converter = getConverter(PixelFormat::BGR24, buffer.format);
+			bytesToRead = converter(ptr, ptr, bytesToRead / BYTES_PER_PIXEL);
 		}
 		if(status != nullptr) {
 			*status = ReadStatus{bytesToRead, buffer.format, true};
@@ -369,6 +362,8 @@ class VirtualSurface : public Surface
 public:
 	VirtualSurface(Virtual& device, size_t bufferSize) : device(device), list(device.addrWindow, bufferSize)
 	{
+		// Reduces transport size
+		list.setRunLengthEncoding(getBytesPerPixel(device.getPixelFormat()));
 	}
 
 	Type getType() const override
@@ -41,90 +41,149 @@ void Blend::write(MetaWriter& meta) const
 	meta.write("mode", ::toString(mode()));
 }
 
-/* BlendXor */
-
-void BlendXor::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+namespace
 {
-	auto srcptr = reinterpret_cast<uint8_t*>(&src);
-	switch(getBytesPerPixel(format)) {
-	case 1:
-		for(; length != 0; length -= 1) {
-			*dstptr++ ^= srcptr[0];
+/*
+ * Bitwise blends are applied a word at a time.
+ * Host builds use 64-bit words, which the compiler can further vectorise.
+ */
+#ifdef ARCH_HOST
+typedef uint64_t __attribute__((__may_alias__)) word_t;
+#else
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+#endif
+
+/*
+ * Apply bitwise operation to a block of pixels using a fixed colour.
+ *
+ * The colour is replicated into a word pattern. For formats where the pixel size doesn't divide
+ * into the word size (RGB24) the pattern spans three words.
+ * Unaligned head and tail bytes are processed individually.
+ */
+template <typename Op> void blendColor(PackedColor src, uint8_t bytesPerPixel, uint8_t* dstptr, size_t length, Op op)
+{
+	if(bytesPerPixel == 0) {
+		return;
+	}
+	auto srcptr = reinterpret_cast<const uint8_t*>(&src);
+
+	size_t head = std::min(length, size_t(-uintptr_t(dstptr) & (sizeof(word_t) - 1)));
+	for(size_t i = 0; i < head; ++i) {
+		op(*dstptr++, srcptr[i % bytesPerPixel]);
+	}
+	length -= head;
+
+	// Pattern starts part-way through a pixel if head was not a whole number of pixels
+	constexpr unsigned maxPatternWords{3};
+	union {
+		uint8_t bytes[maxPatternWords * sizeof(word_t)];
+		word_t words[maxPatternWords];
+	} pattern;
+	for(unsigned i = 0; i < sizeof(pattern.bytes); ++i) {
+		pattern.bytes[i] = srcptr[(head + i) % bytesPerPixel];
+	}
+	unsigned patternWords = (sizeof(word_t) % bytesPerPixel == 0) ? 1 : maxPatternWords;
+
+	auto wordptr = reinterpret_cast<word_t*>(dstptr);
+	size_t wordCount = length / sizeof(word_t);
+	if(patternWords == 1) {
+		auto w = pattern.words[0];
+		for(size_t i = 0; i < wordCount; ++i) {
+			op(wordptr[i], w);
 		}
-		break;
-	case 2:
-		for(; length != 0; length -= 2) {
-			*dstptr++ ^= srcptr[0];
-			*dstptr++ ^= srcptr[1];
+	} else {
+		size_t i = 0;
+		for(; i + 3 <= wordCount; i += 3) {
+			op(wordptr[i], pattern.words[0]);
+			op(wordptr[i + 1], pattern.words[1]);
+			op(wordptr[i + 2], pattern.words[2]);
 		}
-		break;
-	case 3:
-		for(; length != 0; length -= 3) {
-			*dstptr++ ^= srcptr[0];
-			*dstptr++ ^= srcptr[1];
-			*dstptr++ ^= srcptr[2];
+		for(unsigned k = 0; i < wordCount; ++i, ++k) {
+			op(wordptr[i], pattern.words[k]);
 		}
-		break;
+	}
+
+	// Tail continues from where the pattern left off
+	size_t bodyBytes = wordCount * sizeof(word_t);
+	dstptr += bodyBytes;
+	length -= bodyBytes;
+	unsigned offset = bodyBytes % (patternWords * sizeof(word_t));
+	for(size_t i = 0; i < length; ++i) {
+		op(*dstptr++, pattern.bytes[offset + i]);
 	}
 }
 
-void BlendXor::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+/*
+ * Apply bitwise operation to a block of pixels using source buffer.
+ *
+ * Destination is processed in aligned words; source words are read using memcpy
+ * so may have any alignment.
+ */
+template <typename Op> void blendBuffer(const uint8_t* srcptr, uint8_t* dstptr, size_t length, Op op)
 {
-	(void)format;
+	size_t head = std::min(length, size_t(-uintptr_t(dstptr) & (sizeof(word_t) - 1)));
+	length -= head;
+	while(head-- != 0) {
+		op(*dstptr++, *srcptr++);
+	}
+
+	auto wordptr = reinterpret_cast<word_t*>(dstptr);
+	for(; length >= sizeof(word_t); length -= sizeof(word_t)) {
+		word_t w;
+		memcpy(&w, srcptr, sizeof(w));
+		op(*wordptr++, w);
+		srcptr += sizeof(word_t);
+	}
+
+	dstptr = reinterpret_cast<uint8_t*>(wordptr);
 	while(length-- != 0) {
-		*dstptr++ ^= *srcptr++;
+		op(*dstptr++, *srcptr++);
 	}
 }
 
+auto opXor = [](auto& dst, auto src) { dst ^= src; };
+auto opXNor = [](auto& dst, auto src) { dst ^= ~src; };
+auto opMask = [](auto& dst, auto src) { dst &= src; };
+
+} // namespace
+
+/* BlendXor */
+
+void BlendXor::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendColor(src, getBytesPerPixel(format), dstptr, length, opXor);
+}
+
+void BlendXor::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	(void)format;
+	blendBuffer(srcptr, dstptr, length, opXor);
+}
+
 /* BlendXNor */
 
 void BlendXNor::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
 {
-	src.value = ~src.value;
-	BlendXor().transform(format, src, dstptr, length);
+	blendColor(src, getBytesPerPixel(format), dstptr, length, opXNor);
 }
 
 void BlendXNor::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
 {
 	(void)format;
-	while(length-- != 0) {
-		*dstptr++ ^= ~*srcptr++;
-	}
+	blendBuffer(srcptr, dstptr, length, opXNor);
 }
 
 /* BlendMask */
 
 void BlendMask::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
 {
-	auto srcptr = reinterpret_cast<uint8_t*>(&src);
-	switch(getBytesPerPixel(format)) {
-	case 1:
-		for(; length != 0; length -= 1) {
-			*dstptr++ &= srcptr[0];
-		}
-		break;
-	case 2:
-		for(; length != 0; length -= 2) {
-			*dstptr++ &= srcptr[0];
-			*dstptr++ &= srcptr[1];
-		}
-		break;
-	case 3:
-		for(; length != 0; length -= 3) {
-			*dstptr++ &= srcptr[0];
-			*dstptr++ &= srcptr[1];
-			*dstptr++ &= srcptr[2];
-		}
-		break;
-	}
+	blendColor(src, getBytesPerPixel(format), dstptr, length, opMask);
 }
 
 void BlendMask::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
 {
 	(void)format;
-	while(length-- != 0) {
-		*dstptr++ &= *srcptr++;
-	}
+	blendBuffer(srcptr, dstptr, length, opMask);
 }
 
 /* BlendTransparent */
@@ -161,26 +220,129 @@ void BlendTransparent::blend(PixelFormat format, const uint8_t* srcptr, uint8_t*
 		}
 		break;
 	case PixelFormat::BGR24:
-	case PixelFormat::BGRA32:
-		for(; length != 0; length -= 3) {
+	case PixelFormat::BGRA32: {
+		auto bytesPerPixel = getBytesPerPixel(format);
+		for(; length != 0; length -= bytesPerPixel) {
 			PixelBuffer src{.bgr24{srcptr[0], srcptr[1], srcptr[2]}};
 			if(src.rgb24.r <= ref.rgb24.r && src.rgb24.g <= ref.rgb24.g && src.rgb24.b <= ref.rgb24.b) {
 				// auto lum = buf.rgb24.r + buf.rgb24.g + buf.rgb24.b;
 				// auto lumRef = ref.rgb24.r + ref.rgb24.g + ref.rgb24.b;
 				// if(lum <= lumRef) {
-				memcpy(dstptr, srcptr, 3);
+				memcpy(dstptr, srcptr, bytesPerPixel);
 			}
-			dstptr += 3;
-			srcptr += 3;
+			dstptr += bytesPerPixel;
+			srcptr += bytesPerPixel;
 		}
 		break;
+	}
 	case PixelFormat::None:
 		break;
 	}
 }
 
+namespace
+{
+/*
+ * Copy runs of pixels which don't match the key.
+ * Pixels are compared as 16 or 32-bit values, masked to the significant bytes.
+ */
+template <typename T, unsigned bytesPerPixel>
+void copyUnkeyed(const uint8_t* srcptr, uint8_t* dstptr, size_t count, T key, T mask)
+{
+	auto read = [](const uint8_t* ptr) {
+		T value{};
+		memcpy(&value, ptr, bytesPerPixel);
+		return value;
+	};
+
+	size_t i = 0;
+	while(i < count) {
+		// Skip key pixels
+		while(i < count && (read(&srcptr[i * bytesPerPixel]) & mask) == key) {
+			++i;
+		}
+		auto start = i;
+		while(i < count && (read(&srcptr[i * bytesPerPixel]) & mask) != key) {
+			++i;
+		}
+		if(i != start) {
+			auto offset = start * bytesPerPixel;
+			memcpy(&dstptr[offset], &srcptr[offset], (i - start) * bytesPerPixel);
+		}
+	}
+}
+
+} // namespace
+
+void BlendTransparent::blendExact(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length,
+								  Color key)
+{
+	auto ref = pack(key, format);
+	switch(getBytesPerPixel(format)) {
+	case 2:
+		copyUnkeyed<uint16_t, 2>(srcptr, dstptr, length / 2, ref.value, 0xffff);
+		break;
+	case 3:
+		copyUnkeyed<uint32_t, 3>(srcptr, dstptr, length / 3, ref.value, 0xffffff);
+		break;
+	case 4:
+		copyUnkeyed<uint32_t, 4>(srcptr, dstptr, length / 4, ref.value, 0xffffff);
+		break;
+	}
+}
+
 /* BlendAlpha */
 
+namespace
+{
+/*
+ * Alpha blending kernels process a block of pixels or channels per iteration.
+ * GCC vector extensions map these onto SSE/NEON for Host builds; other targets get unrolled scalar code.
+ */
+typedef uint8_t u8x8_t __attribute__((vector_size(8)));
+typedef uint16_t u16x8_t __attribute__((vector_size(16)));
+typedef uint16_t u16x4_t __attribute__((vector_size(8)));
+typedef uint32_t u32x4_t __attribute__((vector_size(16)));
+
+constexpr unsigned blockSize{8};	   ///< Channels per iteration
+constexpr unsigned rgb565BlockSize{4}; ///< RGB565 pixels per iteration
+
+// RGB565 bit layout for parallel multiply, see BlendAlpha::blendRGB565()
+constexpr uint32_t rgb565Mask{0b00000111111000001111100000011111};
+
+// Load 4 big-endian RGB565 pixels
+__forceinline u32x4_t loadRGB565(const uint8_t* ptr)
+{
+	u16x4_t v;
+	memcpy(&v, ptr, sizeof(v));
+	v = (v >> 8) | (v << 8);
+	return __builtin_convertvector(v, u32x4_t);
+}
+
+// Store 4 RGB565 pixels in big-endian format
+__forceinline void storeRGB565(uint8_t* ptr, u32x4_t value)
+{
+	auto v = __builtin_convertvector(value, u16x4_t);
+	v = (v >> 8) | (v << 8);
+	memcpy(ptr, &v, sizeof(v));
+}
+
+__forceinline u32x4_t expandRGB565(u32x4_t value)
+{
+	return (value | (value << 16)) & rgb565Mask;
+}
+
+// As BlendAlpha::blendRGB565() but with foreground pre-expanded and alpha in Q1.5 format
+__forceinline u32x4_t blendRGB565Lanes(u32x4_t fg, u32x4_t dst, uint32_t alpha)
+{
+	auto bg = expandRGB565(dst);
+	auto result = (((fg - bg) * alpha) >> 5) + bg;
+	result &= rgb565Mask;
+	return (result >> 16) | result;
+}
+
+} // namespace
+
 // Fast RGB565 pixel blending
 // Found in a pull request for the Adafruit framebuffer library. Clever!
 // https://github.com/tricorderproject/arducordermini/pull/1/files#diff-d22a481ade4dbb4e41acc4d7c77f683d
@@ -210,7 +372,13 @@ uint16_t BlendAlpha::blendRGB565(uint16_t src, uint16_t dst, uint8_t alpha)
 
 void BlendAlpha::blendRGB565(uint16_t src, uint8_t* dstptr, size_t length, uint8_t alpha)
 {
-	for(; length != 0; length -= 2) {
+	size_t count = length / 2;
+	uint32_t alpha5 = (alpha + 4) >> 3;
+	u32x4_t fg = expandRGB565(u32x4_t{} + src);
+	for(; count >= rgb565BlockSize; count -= rgb565BlockSize, dstptr += rgb565BlockSize * 2) {
+		storeRGB565(dstptr, blendRGB565Lanes(fg, loadRGB565(dstptr), alpha5));
+	}
+	for(; count != 0; --count) {
 		uint16_t dst = (dstptr[0] << 8) | dstptr[1];
 		dst = blendRGB565(src, dst, alpha);
 		*dstptr++ = dst >> 8;
@@ -220,7 +388,14 @@ void BlendAlpha::blendRGB565(uint16_t src, uint8_t* dstptr, size_t length, uint8
 
 void BlendAlpha::blendRGB565(const uint8_t* srcptr, uint8_t* dstptr, size_t length, uint8_t alpha)
 {
-	for(; length != 0; length -= 2) {
+	size_t count = length / 2;
+	uint32_t alpha5 = (alpha + 4) >> 3;
+	for(; count >= rgb565BlockSize;
+		count -= rgb565BlockSize, srcptr += rgb565BlockSize * 2, dstptr += rgb565BlockSize * 2) {
+		auto fg = expandRGB565(loadRGB565(srcptr));
+		storeRGB565(dstptr, blendRGB565Lanes(fg, loadRGB565(dstptr), alpha5));
+	}
+	for(; count != 0; --count) {
 		uint16_t src = (srcptr[0] << 8) | srcptr[1];
 		srcptr += 2;
 		uint16_t dst = (dstptr[0] << 8) | dstptr[1];
@@ -232,22 +407,130 @@ void BlendAlpha::blendRGB565(const uint8_t* srcptr, uint8_t* dstptr, size_t leng
 
 uint8_t BlendAlpha::blendChannel(uint8_t fg, uint8_t bg, uint8_t alpha)
 {
-	uint32_t adst = (255 - alpha) * bg;
-	uint32_t asrc = alpha * fg;
-	uint32_t total = asrc + adst;
-	return total / 255;
+	// Rounded division by 255 using (x + 128) * 257 >> 16
+	uint16_t total = alpha * fg + (255 - alpha) * bg + 128;
+	return (total + (total >> 8)) >> 8;
 }
 
-void BlendAlpha::blendRGB24(PackedColor src, uint8_t* dstptr, size_t length)
+namespace
 {
+/*
+ * Blend 8 channels: fgTerm contains `fg * alpha + 128` and inv is `255 - alpha` for each lane.
+ * All intermediate values fit into 16 bits.
+ */
+__forceinline void blendChannelLanes(uint8_t* dstptr, u16x8_t fgTerm, u16x8_t inv)
+{
+	u8x8_t v;
+	memcpy(&v, dstptr, sizeof(v));
+	auto total = fgTerm + __builtin_convertvector(v, u16x8_t) * inv;
+	total = (total + (total >> 8)) >> 8;
+	v = __builtin_convertvector(total, u8x8_t);
+	memcpy(dstptr, &v, sizeof(v));
+}
+
+__forceinline uint8_t blendChannelLane(uint8_t dst, uint16_t fgTerm, uint16_t inv)
+{
+	uint16_t total = fgTerm + dst * inv;
+	return (total + (total >> 8)) >> 8;
+}
+
+// Alpha channel of BGRA32 pixels is left unchanged by giving it zero weight
+__forceinline uint8_t getLaneAlpha(unsigned bytesPerPixel, unsigned lane, uint8_t alpha)
+{
+	return (bytesPerPixel == 4 && lane % 4 == 3) ? 0 : alpha;
+}
+
+/*
+ * Blend fixed colour with 3 or 4-byte pixels.
+ * The colour pattern repeats every 24 bytes for RGB24, every 8 bytes for BGRA32.
+ */
+template <unsigned bytesPerPixel> void blendColorChannels(PackedColor src, uint8_t* dstptr, size_t length)
+{
+	constexpr unsigned patternBlocks = (bytesPerPixel == 3) ? 3 : 1;
 	auto srcptr = reinterpret_cast<const uint8_t*>(&src);
-	for(unsigned i = 0; i < length; i += 3, dstptr += 3) {
-		dstptr[0] = blendChannel(srcptr[0], dstptr[0], src.alpha);
-		dstptr[1] = blendChannel(srcptr[1], dstptr[1], src.alpha);
-		dstptr[2] = blendChannel(srcptr[2], dstptr[2], src.alpha);
+	u16x8_t fgTerm[patternBlocks];
+	u16x8_t inv[patternBlocks];
+	for(unsigned i = 0; i < patternBlocks * blockSize; ++i) {
+		auto c = i % bytesPerPixel;
+		auto alpha = getLaneAlpha(bytesPerPixel, c, src.alpha);
+		fgTerm[i / blockSize][i % blockSize] = srcptr[c] * alpha + 128;
+		inv[i / blockSize][i % blockSize] = 255 - alpha;
+	}
+
+	constexpr size_t patternSize = patternBlocks * blockSize;
+	for(; length >= patternSize; length -= patternSize) {
+		for(unsigned i = 0; i < patternBlocks; ++i, dstptr += blockSize) {
+			blendChannelLanes(dstptr, fgTerm[i], inv[i]);
+		}
+	}
+	for(unsigned i = 0; i < length; ++i) {
+		auto& fg = fgTerm[i / blockSize];
+		auto& iv = inv[i / blockSize];
+		dstptr[i] = blendChannelLane(dstptr[i], fg[i % blockSize], iv[i % blockSize]);
 	}
 }
 
+template <unsigned bytesPerPixel>
+void blendBufferChannels(const uint8_t* srcptr, uint8_t* dstptr, size_t length, uint8_t alpha)
+{
+	u16x8_t weight;
+	for(unsigned i = 0; i < blockSize; ++i) {
+		weight[i] = getLaneAlpha(bytesPerPixel, i, alpha);
+	}
+	u16x8_t inv = 255 - weight;
+
+	for(; length >= blockSize; length -= blockSize, srcptr += blockSize, dstptr += blockSize) {
+		u8x8_t v;
+		memcpy(&v, srcptr, sizeof(v));
+		auto fgTerm = __builtin_convertvector(v, u16x8_t) * weight + 128;
+		blendChannelLanes(dstptr, fgTerm, inv);
+	}
+	for(unsigned i = 0; i < length; ++i) {
+		dstptr[i] = blendChannelLane(dstptr[i], srcptr[i] * weight[i] + 128, inv[i]);
+	}
+}
+
+void blendColorNone(PackedColor, uint8_t*, size_t)
+{
+}
+
+void blendBufferNone(const uint8_t*, uint8_t*, size_t, uint8_t)
+{
+}
+
+void blendColorRGB565(PackedColor src, uint8_t* dstptr, size_t length)
+{
+	BlendAlpha::blendRGB565(__builtin_bswap16(src.value), dstptr, length, src.alpha);
+}
+
+/*
+ * Kernels are indexed by PixelFormatStruct::mByteCount, which doesn't depend on colour order.
+ * Slot 0 is PixelFormat::None.
+ */
+struct AlphaKernel {
+	void (*blendColor)(PackedColor src, uint8_t* dstptr, size_t length);
+	void (*blendBuffer)(const uint8_t* srcptr, uint8_t* dstptr, size_t length, uint8_t alpha);
+};
+
+constexpr AlphaKernel alphaKernels[]{
+	{blendColorNone, blendBufferNone},
+	{blendColorRGB565, BlendAlpha::blendRGB565},
+	{blendColorChannels<3>, blendBufferChannels<3>},
+	{blendColorChannels<4>, blendBufferChannels<4>},
+};
+
+__forceinline const AlphaKernel& getAlphaKernel(PixelFormat format)
+{
+	return alphaKernels[PixelFormatStruct{format}.mByteCount];
+}
+
+} // namespace
+
+void BlendAlpha::blendRGB24(PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendColorChannels<3>(src, dstptr, length);
+}
+
 PixelBuffer BlendAlpha::blendColor(PixelBuffer fg, PixelBuffer bg, uint8_t alpha)
 {
 	PixelBuffer dst;
@@ -297,27 +580,7 @@ void BlendAlpha::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, siz
 		return;
 	}
 
-	switch(format) {
-	case PixelFormat::RGB565: {
-		blendRGB565(__builtin_bswap16(src.value), dstptr, length, src.alpha);
-		break;
-	}
-
-	case PixelFormat::RGB24:
-		blendRGB24(src, dstptr, length);
-		break;
-
-	default:
-		auto bytesPerPixel = getBytesPerPixel(format);
-		auto fg = unpack(PixelBuffer{.packed{src}}, format);
-		for(unsigned i = 0; i < length; i += bytesPerPixel) {
-			PixelBuffer dst{};
-			memcpy(&dst, dstptr, bytesPerPixel);
-			auto bg = unpack(dst, format);
-			auto cl = blendColor(fg, bg, src.alpha);
-			dstptr += writeColor(dstptr, cl.color, format);
-		}
-	}
+	getAlphaKernel(format).blendColor(src, dstptr, length);
 }
 
 void BlendAlpha::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length, uint8_t alpha)
@@ -332,33 +595,380 @@ void BlendAlpha::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstpt
 		return;
 	}
 
+	getAlphaKernel(format).blendBuffer(srcptr, dstptr, length, alpha);
+}
+
+namespace
+{
+uint16_t blendPremultipliedRGB565(uint16_t src, uint16_t dst, uint8_t alpha)
+{
+	// Scale destination by (1 - alpha) then add source, saturating each component
+	unsigned fg = src;
+	unsigned bg = BlendAlpha::blendRGB565(0, dst, alpha);
+	unsigned r = std::min((fg >> 11) + (bg >> 11), 0x1fU);
+	unsigned g = std::min(((fg >> 5) & 0x3fU) + ((bg >> 5) & 0x3fU), 0x3fU);
+	unsigned b = std::min((fg & 0x1fU) + (bg & 0x1fU), 0x1fU);
+	return (r << 11) | (g << 5) | b;
+}
+
+// Blend pixels which are neither fully opaque nor fully transparent
+void blendPixels(PixelFormat format, const uint8_t* srcptr, const uint8_t* alpha, uint8_t* dstptr, size_t count,
+				 bool premultiplied)
+{
+	if(format == PixelFormat::RGB565) {
+		for(; count != 0; --count, srcptr += 2, dstptr += 2) {
+			uint16_t src = (srcptr[0] << 8) | srcptr[1];
+			uint16_t dst = (dstptr[0] << 8) | dstptr[1];
+			auto a = *alpha++;
+			dst = premultiplied ? blendPremultipliedRGB565(src, dst, a) : BlendAlpha::blendRGB565(src, dst, a);
+			dstptr[0] = dst >> 8;
+			dstptr[1] = dst;
+		}
+		return;
+	}
+
+	// Only colour channels are blended, BGRA32 alpha channel is left unchanged
+	auto bytesPerPixel = getBytesPerPixel(format);
+	for(; count != 0; --count, srcptr += bytesPerPixel, dstptr += bytesPerPixel) {
+		auto a = *alpha++;
+		for(unsigned i = 0; i < 3; ++i) {
+			if(premultiplied) {
+				dstptr[i] = std::min(srcptr[i] + BlendAlpha::blendChannel(0, dstptr[i], a), 255);
+			} else {
+				dstptr[i] = BlendAlpha::blendChannel(srcptr[i], dstptr[i], a);
+			}
+		}
+	}
+}
+
+} // namespace
+
+void BlendAlpha::blend(PixelFormat format, const uint8_t* srcptr, const uint8_t* alpha, uint8_t* dstptr, size_t count,
+					   bool premultiplied)
+{
+	if(format == PixelFormat::None) {
+		return;
+	}
+
+	auto bytesPerPixel = getBytesPerPixel(format);
+	while(count != 0) {
+		// Find run of pixels requiring the same treatment
+		auto a = alpha[0];
+		size_t run{1};
+		if(a == 0 || a == 255) {
+			while(run < count && alpha[run] == a) {
+				++run;
+			}
+		} else {
+			while(run < count && alpha[run] != 0 && alpha[run] != 255) {
+				++run;
+			}
+		}
+
+		auto length = run * bytesPerPixel;
+		if(a == 255) {
+			memcpy(dstptr, srcptr, length);
+		} else if(a != 0) {
+			blendPixels(format, srcptr, alpha, dstptr, run, premultiplied);
+		}
+
+		srcptr += length;
+		dstptr += length;
+		alpha += run;
+		count -= run;
+	}
+}
+
+namespace
+{
+/*
+ * Separable blend modes operate on each colour channel independently.
+ * Operations are templated on the maximum channel value so RGB565 fields can be handled directly.
+ */
+struct OpMultiply {
+	template <unsigned max> static unsigned apply(unsigned src, unsigned dst)
+	{
+		return (src * dst + max / 2) / max;
+	}
+};
+
+struct OpScreen {
+	template <unsigned max> static unsigned apply(unsigned src, unsigned dst)
+	{
+		return src + dst - OpMultiply::apply<max>(src, dst);
+	}
+};
+
+struct OpAdd {
+	template <unsigned max> static unsigned apply(unsigned src, unsigned dst)
+	{
+		return std::min(src + dst, max);
+	}
+};
+
+struct OpSubtract {
+	template <unsigned max> static unsigned apply(unsigned src, unsigned dst)
+	{
+		return (dst > src) ? dst - src : 0;
+	}
+};
+
+struct OpDarken {
+	template <unsigned max> static unsigned apply(unsigned src, unsigned dst)
+	{
+		return std::min(src, dst);
+	}
+};
+
+struct OpLighten {
+	template <unsigned max> static unsigned apply(unsigned src, unsigned dst)
+	{
+		return std::max(src, dst);
+	}
+};
+
+template <class Op> __forceinline uint16_t applyRGB565(uint16_t src, uint16_t dst)
+{
+	unsigned r = Op::template apply<0x1f>(src >> 11, dst >> 11);
+	unsigned g = Op::template apply<0x3f>((src >> 5) & 0x3f, (dst >> 5) & 0x3f);
+	unsigned b = Op::template apply<0x1f>(src & 0x1f, dst & 0x1f);
+	return (r << 11) | (g << 5) | b;
+}
+
+// Colour channels only, BGRA32 alpha is left unchanged
+template <class Op> __forceinline void applyRGB(const uint8_t* srcptr, uint8_t* dstptr)
+{
+	dstptr[0] = Op::template apply<0xff>(srcptr[0], dstptr[0]);
+	dstptr[1] = Op::template apply<0xff>(srcptr[1], dstptr[1]);
+	dstptr[2] = Op::template apply<0xff>(srcptr[2], dstptr[2]);
+}
+
+template <class Op> void blendSeparable(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	switch(format) {
+	case PixelFormat::RGB565: {
+		uint16_t fg = __builtin_bswap16(src.value);
+		for(; length >= 2; length -= 2, dstptr += 2) {
+			uint16_t bg = (dstptr[0] << 8) | dstptr[1];
+			bg = applyRGB565<Op>(fg, bg);
+			dstptr[0] = bg >> 8;
+			dstptr[1] = bg;
+		}
+		break;
+	}
+
+	case PixelFormat::RGB24:
+	case PixelFormat::BGR24:
+		for(; length >= 3; length -= 3, dstptr += 3) {
+			applyRGB<Op>(reinterpret_cast<const uint8_t*>(&src), dstptr);
+		}
+		break;
+
+	case PixelFormat::BGRA32:
+		for(; length >= 4; length -= 4, dstptr += 4) {
+			applyRGB<Op>(reinterpret_cast<const uint8_t*>(&src), dstptr);
+		}
+		break;
+
+	case PixelFormat::None:
+		break;
+	}
+}
+
+template <class Op> void blendSeparable(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
 	switch(format) {
 	case PixelFormat::RGB565:
-		blendRGB565(srcptr, dstptr, length, alpha);
+		for(; length >= 2; length -= 2, srcptr += 2, dstptr += 2) {
+			uint16_t fg = (srcptr[0] << 8) | srcptr[1];
+			uint16_t bg = (dstptr[0] << 8) | dstptr[1];
+			bg = applyRGB565<Op>(fg, bg);
+			dstptr[0] = bg >> 8;
+			dstptr[1] = bg;
+		}
 		break;
 
 	case PixelFormat::RGB24:
-		while(length-- != 0) {
-			auto value = blendChannel(*srcptr++, *dstptr, alpha);
-			*dstptr++ = value;
+	case PixelFormat::BGR24:
+		for(; length >= 3; length -= 3, srcptr += 3, dstptr += 3) {
+			applyRGB<Op>(srcptr, dstptr);
 		}
 		break;
 
-	default:
-		auto bytesPerPixel = getBytesPerPixel(format);
-		for(unsigned i = 0; i < length; i += bytesPerPixel) {
-			PixelBuffer src{};
-			memcpy(&src, srcptr, bytesPerPixel);
-			PixelBuffer dst{};
-			memcpy(&dst, dstptr, bytesPerPixel);
-			auto fg = unpack(src, format);
-			auto bg = unpack(dst, format);
-			auto cl = blendColor(fg, bg, alpha);
-			dst = pack(PixelBuffer{cl}, format);
-			memcpy(dstptr, &dst, bytesPerPixel);
-			srcptr += bytesPerPixel;
-			dstptr += bytesPerPixel;
+	case PixelFormat::BGRA32:
+		for(; length >= 4; length -= 4, srcptr += 4, dstptr += 4) {
+			applyRGB<Op>(srcptr, dstptr);
+		}
+		break;
+
+	case PixelFormat::None:
+		break;
+	}
+}
+
+} // namespace
+
+/* BlendMultiply */
+
+void BlendMultiply::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpMultiply>(format, src, dstptr, length);
+}
+
+void BlendMultiply::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpMultiply>(format, srcptr, dstptr, length);
+}
+
+/* BlendScreen */
+
+void BlendScreen::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpScreen>(format, src, dstptr, length);
+}
+
+void BlendScreen::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpScreen>(format, srcptr, dstptr, length);
+}
+
+/* BlendAdd */
+
+void BlendAdd::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpAdd>(format, src, dstptr, length);
+}
+
+void BlendAdd::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpAdd>(format, srcptr, dstptr, length);
+}
+
+/* BlendSubtract */
+
+void BlendSubtract::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpSubtract>(format, src, dstptr, length);
+}
+
+void BlendSubtract::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpSubtract>(format, srcptr, dstptr, length);
+}
+
+/* BlendDarken */
+
+void BlendDarken::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpDarken>(format, src, dstptr, length);
+}
+
+void BlendDarken::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpDarken>(format, srcptr, dstptr, length);
+}
+
+/* BlendLighten */
+
+void BlendLighten::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpLighten>(format, src, dstptr, length);
+}
+
+void BlendLighten::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	blendSeparable<OpLighten>(format, srcptr, dstptr, length);
+}
+
+namespace
+{
+/*
+ * Porter-Duff 'over' for BGRA32 pixels with straight alpha.
+ * The top pixel is composited over the bottom one and the result written to dstptr.
+ */
+void compositeOver(const uint8_t* top, const uint8_t* bottom, uint8_t* dstptr)
+{
+	unsigned topAlpha = top[3];
+	unsigned bottomAlpha = bottom[3];
+	if(topAlpha == 255 || bottomAlpha == 0) {
+		memmove(dstptr, top, 4);
+		return;
+	}
+	if(topAlpha == 0) {
+		memmove(dstptr, bottom, 4);
+		return;
+	}
+	if(bottomAlpha == 255) {
+		for(unsigned i = 0; i < 3; ++i) {
+			dstptr[i] = BlendAlpha::blendChannel(top[i], bottom[i], topAlpha);
 		}
+		dstptr[3] = 255;
+		return;
+	}
+
+	// Bottom contribution scaled by its own alpha
+	unsigned bottomWeight = bottomAlpha * (255 - topAlpha);
+	unsigned outAlpha = topAlpha * 255 + bottomWeight;
+	for(unsigned i = 0; i < 3; ++i) {
+		unsigned total = top[i] * topAlpha * 255 + bottom[i] * bottomWeight;
+		dstptr[i] = (total + outAlpha / 2) / outAlpha;
+	}
+	dstptr[3] = (outAlpha + 127) / 255;
+}
+
+} // namespace
+
+/* BlendSrcOver */
+
+void BlendSrcOver::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	if(format != PixelFormat::BGRA32) {
+		BlendAlpha::blend(format, src, dstptr, length);
+		return;
+	}
+
+	auto srcptr = reinterpret_cast<const uint8_t*>(&src);
+	for(; length >= 4; length -= 4, dstptr += 4) {
+		compositeOver(srcptr, dstptr, dstptr);
+	}
+}
+
+void BlendSrcOver::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	if(format != PixelFormat::BGRA32) {
+		// Source is opaque
+		memcpy(dstptr, srcptr, length);
+		return;
+	}
+
+	for(; length >= 4; length -= 4, srcptr += 4, dstptr += 4) {
+		compositeOver(srcptr, dstptr, dstptr);
+	}
+}
+
+/* BlendDstOver */
+
+void BlendDstOver::blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	if(format != PixelFormat::BGRA32) {
+		// Destination is opaque
+		return;
+	}
+
+	auto srcptr = reinterpret_cast<const uint8_t*>(&src);
+	for(; length >= 4; length -= 4, dstptr += 4) {
+		compositeOver(dstptr, srcptr, dstptr);
+	}
+}
+
+void BlendDstOver::blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	if(format != PixelFormat::BGRA32) {
+		return;
+	}
+
+	for(; length >= 4; length -= 4, srcptr += 4, dstptr += 4) {
+		compositeOver(dstptr, srcptr, dstptr);
 	}
 }
 
@@ -23,6 +23,7 @@
 #include <FlashString/Map.hpp>
 #include <stringconversion.h>
 #include <cassert>
+#include <algorithm>
 
 String toString(Graphics::Color color)
 {
@@ -150,6 +151,12 @@ size_t writeColor(void* buffer, PackedColor color, PixelFormat format)
 		*ptr++ = color.value >> 8;
 		*ptr++ = color.value >> 16;
 		break;
+	case 4:
+		*ptr++ = color.value;
+		*ptr++ = color.value >> 8;
+		*ptr++ = color.value >> 16;
+		*ptr++ = color.alpha;
+		break;
 	default:
 		assert(false);
 	}
@@ -158,58 +165,241 @@ size_t writeColor(void* buffer, PackedColor color, PixelFormat format)
 
 size_t writeColor(void* buffer, PackedColor color, PixelFormat format, size_t count)
 {
-	auto ptr = static_cast<uint8_t*>(buffer);
-	switch(getBytesPerPixel(format)) {
+	auto bytesPerPixel = getBytesPerPixel(format);
+	size_t length = count * bytesPerPixel;
+
+	/*
+	 * Build a pattern of whole words containing complete pixels.
+	 * Bytes are stored in little-endian order as for single pixels.
+	 */
+	uint32_t pattern[3];
+	size_t patternLength{sizeof(uint32_t)};
+	switch(bytesPerPixel) {
 	case 1:
 		memset(buffer, color.value, count);
-		ptr += count;
-		break;
+		return count;
 	case 2:
-		while(count-- > 0) {
-			*ptr++ = color.value;
-			*ptr++ = color.value >> 8;
-		}
+		pattern[0] = (color.value & 0xffff) * 0x00010001U;
 		break;
-	case 3:
-		while(count-- > 0) {
-			*ptr++ = color.value;
-			*ptr++ = color.value >> 8;
-			*ptr++ = color.value >> 16;
-		}
+	case 3: {
+		uint32_t value = color.value;
+		pattern[0] = value | (value << 24);
+		pattern[1] = (value >> 8) | (value << 16);
+		pattern[2] = (value >> 16) | (value << 8);
+		patternLength = sizeof(pattern);
+		break;
+	}
+	case 4:
+		pattern[0] = color.value | (uint32_t(color.alpha) << 24);
 		break;
 	default:
 		assert(false);
+		return 0;
 	}
-	return ptr - static_cast<uint8_t*>(buffer);
+
+	auto ptr = static_cast<uint8_t*>(buffer);
+	if(length <= patternLength) {
+		memcpy(ptr, pattern, length);
+		return length;
+	}
+
+	// Seed the buffer then keep doubling it
+	memcpy(ptr, pattern, patternLength);
+	size_t done = patternLength;
+	while(done < length) {
+		auto n = std::min(done, length - done);
+		memcpy(&ptr[done], ptr, n);
+		done += n;
+	}
+	return length;
+}
+
+namespace
+{
+// As getBytesPerPixel() but usable in constant expressions
+constexpr uint8_t bytesPerPixel(PixelFormat format)
+{
+	return (uint8_t(format) & 0x03) + 1;
 }
 
-size_t convert(const void* srcData, PixelFormat srcFormat, void* dstBuffer, PixelFormat dstFormat, size_t numPixels)
+/*
+ * General conversion via Color.
+ * Pixels which expand are converted from the end backwards so buffers may be shared.
+ */
+template <PixelFormat srcFormat, PixelFormat dstFormat>
+size_t convertPixels(const void* srcData, void* dstBuffer, size_t numPixels)
 {
+	constexpr auto srcBytes = bytesPerPixel(srcFormat);
+	constexpr auto dstBytes = bytesPerPixel(dstFormat);
+	constexpr bool reverse = (dstBytes > srcBytes);
 	auto srcptr = static_cast<const uint8_t*>(srcData);
 	auto dstptr = static_cast<uint8_t*>(dstBuffer);
-	switch(getBytesPerPixel(srcFormat)) {
-	case 1:
-		while(numPixels-- > 0) {
-			PixelBuffer src{.u8{*srcptr++}};
-			dstptr += writeColor(dstptr, unpack(src, srcFormat).color, dstFormat);
-		}
-		break;
-	case 2:
-		while(numPixels-- > 0) {
-			PixelBuffer src{.u8{*srcptr++, *srcptr++}};
-			dstptr += writeColor(dstptr, unpack(src, srcFormat).color, dstFormat);
-		}
-		break;
-	case 3:
-		while(numPixels-- > 0) {
-			PixelBuffer src{.u8{*srcptr++, *srcptr++, *srcptr++}};
-			dstptr += writeColor(dstptr, unpack(src, srcFormat).color, dstFormat);
+	for(size_t i = 0; i < numPixels; ++i) {
+		size_t n = reverse ? numPixels - 1 - i : i;
+		PixelBuffer buf{};
+		memcpy(&buf, &srcptr[n * srcBytes], srcBytes);
+		buf = pack(unpack(buf, srcFormat), dstFormat);
+		memcpy(&dstptr[n * dstBytes], &buf, dstBytes);
+	}
+	return numPixels * dstBytes;
+}
+
+template <PixelFormat format> size_t copyPixels(const void* srcData, void* dstBuffer, size_t numPixels)
+{
+	size_t length = numPixels * bytesPerPixel(format);
+	memmove(dstBuffer, srcData, length);
+	return length;
+}
+
+size_t convertNone(const void*, void*, size_t)
+{
+	return 0;
+}
+
+__forceinline void writeRGB565(uint8_t*& dstptr, uint16_t color)
+{
+	*dstptr++ = color >> 8;
+	*dstptr++ = color;
+}
+
+__forceinline uint16_t makeRGB565(uint8_t r, uint8_t g, uint8_t b)
+{
+	return ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
+}
+
+// Swap first and third bytes of each pixel
+size_t convertRGB24_BGR24(const void* srcData, void* dstBuffer, size_t numPixels)
+{
+	auto srcptr = static_cast<const uint8_t*>(srcData);
+	auto dstptr = static_cast<uint8_t*>(dstBuffer);
+	for(size_t i = 0; i < numPixels; ++i, srcptr += 3, dstptr += 3) {
+		uint8_t c0 = srcptr[0];
+		dstptr[1] = srcptr[1];
+		dstptr[0] = srcptr[2];
+		dstptr[2] = c0;
+	}
+	return numPixels * 3;
+}
+
+size_t convertRGB24_RGB565(const void* srcData, void* dstBuffer, size_t numPixels)
+{
+	auto srcptr = static_cast<const uint8_t*>(srcData);
+	auto dstptr = static_cast<uint8_t*>(dstBuffer);
+	for(size_t i = 0; i < numPixels; ++i, srcptr += 3) {
+		writeRGB565(dstptr, makeRGB565(srcptr[0], srcptr[1], srcptr[2]));
+	}
+	return numPixels * 2;
+}
+
+size_t convertBGR24_RGB565(const void* srcData, void* dstBuffer, size_t numPixels)
+{
+	auto srcptr = static_cast<const uint8_t*>(srcData);
+	auto dstptr = static_cast<uint8_t*>(dstBuffer);
+	for(size_t i = 0; i < numPixels; ++i, srcptr += 3) {
+		writeRGB565(dstptr, makeRGB565(srcptr[2], srcptr[1], srcptr[0]));
+	}
+	return numPixels * 2;
+}
+
+// Each pixel is loaded as a little-endian word and the channels extracted in place
+size_t convertBGRA32_RGB565(const void* srcData, void* dstBuffer, size_t numPixels)
+{
+	auto srcptr = static_cast<const uint8_t*>(srcData);
+	auto dstptr = static_cast<uint8_t*>(dstBuffer);
+	for(size_t i = 0; i < numPixels; ++i, srcptr += 4) {
+		uint32_t w;
+		memcpy(&w, srcptr, sizeof(w));
+		writeRGB565(dstptr, ((w >> 8) & 0xf800) | ((w >> 5) & 0x07e0) | ((w >> 3) & 0x001f));
+	}
+	return numPixels * 2;
+}
+
+/*
+ * RGB565 expands to a larger pixel so conversion runs backwards.
+ * Channels are shifted without bit replication, matching unpack().
+ */
+template <unsigned r, unsigned g, unsigned b, unsigned dstBytes>
+size_t convertRGB565(const void* srcData, void* dstBuffer, size_t numPixels)
+{
+	auto srcptr = static_cast<const uint8_t*>(srcData) + numPixels * 2;
+	auto dstptr = static_cast<uint8_t*>(dstBuffer) + numPixels * dstBytes;
+	for(size_t i = 0; i < numPixels; ++i) {
+		srcptr -= 2;
+		dstptr -= dstBytes;
+		uint8_t hi = srcptr[0];
+		uint8_t lo = srcptr[1];
+		dstptr[r] = hi & 0xf8;
+		dstptr[g] = ((hi & 0x07) << 5) | ((lo >> 3) & 0x1c);
+		dstptr[b] = lo << 3;
+		if(dstBytes == 4) {
+			dstptr[3] = 0xff;
 		}
-		break;
+	}
+	return numPixels * dstBytes;
+}
+
+constexpr unsigned getFormatIndex(PixelFormat format)
+{
+	switch(format) {
+	case PixelFormat::RGB24:
+		return 1;
+	case PixelFormat::BGRA32:
+		return 2;
+	case PixelFormat::BGR24:
+		return 3;
+	case PixelFormat::RGB565:
+		return 4;
 	default:
-		assert(false);
+		return 0;
 	}
-	return dstptr - static_cast<uint8_t*>(dstBuffer);
+}
+
+constexpr unsigned formatCount{5};
+
+struct ConverterTable {
+	PixelConverter converters[formatCount][formatCount]{};
+
+	template <PixelFormat src, PixelFormat dst> constexpr void set(PixelConverter converter)
+	{
+		converters[getFormatIndex(src)][getFormatIndex(dst)] = converter;
+	}
+
+	template <PixelFormat src, PixelFormat... dst> constexpr void setGeneral()
+	{
+		(set<src, dst>(convertPixels<src, dst>), ...);
+	}
+
+	constexpr ConverterTable()
+	{
+		setGeneral<PixelFormat::RGB24, PixelFormat::BGRA32, PixelFormat::BGR24, PixelFormat::RGB565>();
+		setGeneral<PixelFormat::BGRA32, PixelFormat::RGB24, PixelFormat::BGR24, PixelFormat::RGB565>();
+		setGeneral<PixelFormat::BGR24, PixelFormat::RGB24, PixelFormat::BGRA32, PixelFormat::RGB565>();
+		setGeneral<PixelFormat::RGB565, PixelFormat::RGB24, PixelFormat::BGRA32, PixelFormat::BGR24>();
+
+		set<PixelFormat::RGB24, PixelFormat::RGB24>(copyPixels<PixelFormat::RGB24>);
+		set<PixelFormat::BGRA32, PixelFormat::BGRA32>(copyPixels<PixelFormat::BGRA32>);
+		set<PixelFormat::BGR24, PixelFormat::BGR24>(copyPixels<PixelFormat::BGR24>);
+		set<PixelFormat::RGB565, PixelFormat::RGB565>(copyPixels<PixelFormat::RGB565>);
+
+		set<PixelFormat::RGB24, PixelFormat::BGR24>(convertRGB24_BGR24);
+		set<PixelFormat::BGR24, PixelFormat::RGB24>(convertRGB24_BGR24);
+		set<PixelFormat::RGB24, PixelFormat::RGB565>(convertRGB24_RGB565);
+		set<PixelFormat::BGR24, PixelFormat::RGB565>(convertBGR24_RGB565);
+		set<PixelFormat::BGRA32, PixelFormat::RGB565>(convertBGRA32_RGB565);
+		set<PixelFormat::RGB565, PixelFormat::RGB24>(convertRGB565<0, 1, 2, 3>);
+		set<PixelFormat::RGB565, PixelFormat::BGR24>(convertRGB565<2, 1, 0, 3>);
+		set<PixelFormat::RGB565, PixelFormat::BGRA32>(convertRGB565<2, 1, 0, 4>);
+	}
+};
+
+constexpr ConverterTable converterTable;
+
+} // namespace
+
+PixelConverter getConverter(PixelFormat srcFormat, PixelFormat dstFormat)
+{
+	auto converter = converterTable.converters[getFormatIndex(srcFormat)][getFormatIndex(dstFormat)];
+	return converter ?: convertNone;
 }
 
 } // namespace Graphics
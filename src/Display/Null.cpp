@@ -24,18 +24,35 @@
  ****/
 
 #include <Graphics/Display/Null.h>
+#include <Graphics/MipiDisplay.h>
 #include <Platform/System.h>
 
 namespace Graphics
 {
 namespace Display
 {
+namespace
+{
+// Bits clocked at a given frequency, in nanoseconds
+uint64_t bitTime(uint64_t bits, uint32_t speed)
+{
+	return speed ? (bits * 1000000000ULL + speed / 2) / speed : 0;
+}
+
+} // namespace
+
 class NullSurface : public Surface
 {
 public:
-	NullSurface(NullDevice& device, uint16_t bufferSize)
-		: device(device), buffer(new uint8_t[bufferSize]), bufferSize(bufferSize)
+	NullSurface(NullDevice& device, uint16_t bufferSize) : device(device), bufferSize(bufferSize)
 	{
+		if(device.busModel) {
+			list.reset(new SpiDisplayList(MipiDisplay::commands, device.addrWindow, bufferSize));
+			auto minRepeats = device.getRunLengthEncoding();
+			list->setRunLengthEncoding(minRepeats ? getBytesPerPixel(device.getPixelFormat()) : 0, minRepeats);
+		} else {
+			buffer.reset(new uint8_t[bufferSize]);
+		}
 	}
 
 	Type getType() const override
@@ -45,6 +62,12 @@ public:
 
 	Stat stat() const override
 	{
+		if(list) {
+			return Stat{
+				.used = list->used(),
+				.available = list->freeSpace(),
+			};
+		}
 		return Stat{
 			.used = 0,
 			.available = 0xffff,
@@ -63,24 +86,37 @@ public:
 
 	bool setAddrWindow(const Rect& rect) override
 	{
+		if(list) {
+			return list->setAddrWindow(rect);
+		}
 		device.addrWindow = rect;
 		return true;
 	}
 
 	uint8_t* getBuffer(uint16_t minBytes, uint16_t& available) override
 	{
+		if(list) {
+			return list->getBuffer(minBytes, available);
+		}
 		available = bufferSize;
 		return (available >= minBytes) ? buffer.get() : nullptr;
 	}
 
 	void commit(uint16_t length) override
 	{
+		if(list) {
+			list->commit(length);
+			return;
+		}
 		(void)length;
 		assert(length <= bufferSize);
 	}
 
 	bool blockFill(const void* data, uint16_t length, uint32_t repeat) override
 	{
+		if(list) {
+			return list->blockFill(data, length, repeat);
+		}
 		(void)data;
 		(void)length;
 		(void)repeat;
@@ -89,6 +125,9 @@ public:
 
 	bool writeDataBuffer(SharedBuffer& data, size_t offset, uint16_t length) override
 	{
+		if(list) {
+			return list->writeDataBuffer(data, offset, length);
+		}
 		(void)data;
 		(void)offset;
 		(void)length;
@@ -97,6 +136,9 @@ public:
 
 	bool setPixel(PackedColor color, Point pt) override
 	{
+		if(list) {
+			return list->setPixel(color, getBytesPerPixel(getPixelFormat()), pt);
+		}
 		(void)color;
 		(void)pt;
 		return true;
@@ -114,6 +156,10 @@ public:
 			return 0;
 		}
 
+		if(list && !recordRead(pixelCount)) {
+			return -1;
+		}
+
 		addrWindow.seek(pixelCount);
 
 		if(buffer.format == PixelFormat::None) {
@@ -135,23 +181,150 @@ public:
 
 	void reset() override
 	{
+		if(list) {
+			list->reset();
+		}
 	}
 
 	bool present(PresentCallback callback, void* param) override
 	{
+		if(list) {
+			if(list->isEmpty()) {
+				return false;
+			}
+			device.execute(*list);
+		}
 		return System.queueCallback(callback, param);
 	}
 
 private:
+	/*
+	 * Add read transactions to the list as MipiSurface does, so they're accounted for.
+	 * Pixels are read in RGB24 format and the first transaction after RAMRD is limited in size.
+	 * Data is provided immediately by the caller so the target address is never written to.
+	 */
+	bool recordRead(size_t pixelCount)
+	{
+		constexpr size_t readPixelSize{3};
+		constexpr size_t packetPixelBytes{63};
+
+		constexpr size_t hdrsize = DisplayList::codelen_readStart + DisplayList::codelen_read;
+		if(!list->require(hdrsize)) {
+			return false;
+		}
+
+		auto bytesToRead = pixelCount * readPixelSize;
+		if(device.addrWindow.mode == AddressWindow::Mode::read) {
+			return list->readMem(&dummyRead, bytesToRead);
+		}
+		auto len = std::min(bytesToRead, packetPixelBytes);
+		if(!list->readMem(&dummyRead, len)) {
+			return false;
+		}
+		return len == bytesToRead || list->readMem(&dummyRead, bytesToRead - len);
+	}
+
 	NullDevice& device;
 	std::unique_ptr<uint8_t[]> buffer;
+	std::unique_ptr<SpiDisplayList> list;
 	size_t bufferSize;
+	uint8_t dummyRead;
 };
 
+/* NullDevice */
+
 Surface* NullDevice::createSurface(size_t bufferSize)
 {
 	return new NullSurface(*this, bufferSize ?: 512U);
 }
 
+/*
+ * Expand the list into SPI requests using the same code as the MIPI driver,
+ * classifying each one by the most recent command.
+ */
+void NullDevice::execute(SpiDisplayList& list)
+{
+	auto& commands = MipiDisplay::commands;
+	enum class Phase { command, address, write, read };
+	Phase phase{Phase::command};
+	uint64_t commandBits{0};
+	uint64_t addressBits{0};
+	uint64_t writeBits{0};
+	uint64_t readBits{0};
+	uint32_t requests{0};
+
+	list.prepare(nullptr, nullptr);
+	while(list.fillRequest()) {
+		auto& req = list.request;
+		++requests;
+		if(req.cmdLen != 0) {
+			++busStats.commands;
+			uint8_t cmd = req.cmd;
+			if(cmd == commands.setColumn || cmd == commands.setRow) {
+				++busStats.windowChanges;
+				phase = Phase::address;
+			} else if(cmd == commands.writeStart) {
+				phase = Phase::write;
+			} else if(cmd == commands.readStart || cmd == commands.read) {
+				++busStats.reads;
+				phase = Phase::read;
+			} else {
+				phase = Phase::command;
+			}
+		}
+
+		busStats.bytesOut += req.out.length;
+		busStats.bytesIn += req.in.length;
+		uint32_t outBits = req.out.length * 8U;
+		switch(phase) {
+		case Phase::command:
+			commandBits += req.cmdLen + outBits;
+			break;
+		case Phase::address:
+			commandBits += req.cmdLen;
+			addressBits += outBits;
+			break;
+		case Phase::write:
+			commandBits += req.cmdLen;
+			writeBits += outBits;
+			break;
+		case Phase::read:
+			// Command is clocked at read speed as it's part of the same transaction
+			readBits += req.cmdLen + req.dummyLen + req.in.length * 8U;
+			break;
+		}
+	}
+
+	++busStats.lists;
+	busStats.requests += requests;
+	busStats.commandTime += bitTime(commandBits, busTiming.writeSpeed);
+	busStats.addressTime += bitTime(addressBits, busTiming.writeSpeed);
+	busStats.writeTime += bitTime(writeBits, busTiming.writeSpeed);
+	busStats.readTime += bitTime(readBits, busTiming.readSpeed);
+	busStats.overheadTime += uint64_t(requests) * busTiming.requestOverhead;
+}
+
+/* NullDevice::BusStats */
+
+void NullDevice::BusStats::write(MetaWriter& meta) const
+{
+	auto us = [](uint64_t ns) -> uint32_t { return (ns + 500) / 1000; };
+
+	meta.write("lists", lists);
+	meta.write("requests", requests);
+	meta.write("commands", commands);
+	meta.write("windowChanges", windowChanges);
+	meta.write("reads", reads);
+	meta.write("bytesOut", bytesOut);
+	meta.write("bytesIn", bytesIn);
+	meta.write("commandTimeUs", us(commandTime));
+	meta.write("addressTimeUs", us(addressTime));
+	meta.write("writeTimeUs", us(writeTime));
+	meta.write("readTimeUs", us(readTime));
+	meta.write("overheadTimeUs", us(overheadTime));
+	meta.write("busTimeUs", us(getBusTime()));
+	meta.write("pixelDataShare", getPixelDataShare());
+}
+
 } // namespace Display
 } // namespace Graphics
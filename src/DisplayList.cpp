@@ -20,10 +20,12 @@
  ****/
 
 #include "include/Graphics/DisplayList.h"
+#include "include/Graphics/Object.h"
 #include <HSPI/Controller.h>
 #include <Platform/System.h>
 #include <esp_attr.h>
 #include <cassert>
+#include <algorithm>
 
 namespace Graphics
 {
@@ -43,6 +45,15 @@ String DisplayList::toString(Code code)
 void DisplayList::reset()
 {
 	// debug_i("%p DisplayList::reset()", this);
+#ifdef ENABLE_GRAPHICS_DL_STATS
+	if(size != 0) {
+		updateStats();
+	}
+#endif
+	if(offset < size) {
+		// List was not executed so any window it set never reached the display
+		addrWindow.invalidate();
+	}
 	offset = size = 0;
 	for(unsigned i = 0; i < lockCount; ++i) {
 		lockedBuffers[i] = SharedBuffer{};
@@ -75,16 +86,86 @@ void DisplayList::commit(uint16_t length)
 {
 	constexpr size_t hdrsize{3};
 	assert(require(hdrsize + length));
+	if(rlePixelBytes != 0 && length >= getMinRunLength()) {
+		commitEncoded(length);
+		return;
+	}
 	writeHeader(getWriteCode(), 0x8000 | length);
 	size += length;
 }
 
+void DisplayList::setRunLengthEncoding(uint8_t bytesPerPixel, uint8_t minRepeats)
+{
+	assert(bytesPerPixel <= 4);
+	rlePixelBytes = bytesPerPixel;
+	rleMinRepeats = minRepeats;
+}
+
+uint16_t DisplayList::getMinRunLength() const
+{
+	/*
+	 * Encoding is done in-place so output must never overtake input.
+	 * A repeat chunk plus the following data header takes at most 7 bytes plus one pixel.
+	 */
+	return std::max(rleMinRepeats * rlePixelBytes, 7 + rlePixelBytes);
+}
+
+/*
+ * Data has been written following a reserved 3-byte header.
+ * Re-write it as a sequence of data and repeat chunks, moving content down as required.
+ * Runs are detected at pixel boundaries so each chunk contains whole pixels.
+ */
+void DisplayList::commitEncoded(uint16_t length)
+{
+	constexpr size_t hdrsize{3};
+	const unsigned bpp = rlePixelBytes;
+	const unsigned minRunLength = getMinRunLength();
+	auto data = &buffer[size + hdrsize];
+	uint16_t literalStart{0};
+
+	auto writeLiteral = [&](uint16_t end) {
+		if(end == literalStart) {
+			return;
+		}
+		uint16_t len = end - literalStart;
+		writeHeader(getWriteCode(), len);
+		memmove(&buffer[size], &data[literalStart], len);
+		size += len;
+	};
+
+	uint16_t pos{0};
+	while(pos + minRunLength <= length) {
+		auto pixel = &data[pos];
+		unsigned end = pos + bpp;
+		while(end + bpp <= length && memcmp(&data[end], pixel, bpp) == 0 && (end - pos) / bpp < 0x7fff) {
+			end += bpp;
+		}
+		if(end - pos >= minRunLength) {
+			writeLiteral(pos);
+			// Pixel may get overwritten by header
+			uint8_t pattern[4];
+			memcpy(pattern, pixel, bpp);
+			if(addrWindow.setMode(AddressWindow::Mode::write)) {
+				writeHeader(Code::writeStart, 0);
+			}
+			writeHeader(Code::repeat, bpp);
+			writeVar((end - pos) / bpp);
+			write(pattern, bpp);
+			literalStart = end;
+		}
+		pos = end;
+	}
+	writeLiteral(length);
+}
+
 bool DisplayList::writeCommand(uint8_t command, const void* data, uint16_t length)
 {
 	constexpr size_t hdrsize = codelen_command;
 	if(!require(hdrsize + length)) {
 		return false;
 	}
+	// Commands may affect how the display interprets its address window
+	addrWindow.invalidate();
 	addrWindow.mode = AddressWindow::Mode::none;
 	writeHeader(Code::command, length);
 	write(command);
@@ -124,10 +205,35 @@ bool DisplayList::writeDataBuffer(SharedBuffer& data, size_t offset, uint16_t le
 
 void DisplayList::internalSetAddrWindow(const Rect& rect)
 {
-	writeHeader(Code::setColumn, rect.w - 1);
-	writeVar(rect.x);
-	writeHeader(Code::setRow, rect.h - 1);
-	writeVar(rect.y);
+	/*
+	 * Only send axes which differ from the window the display already has.
+	 * Changing the window always resets the mode so the next transfer starts with
+	 * writeStart/readStart, which returns the display to the start of the window.
+	 */
+	auto& committed = addrWindow.committed;
+	bool known = bool(committed);
+	auto elided = elidedCommands;
+	if(known && rect.x == committed.x && rect.w == committed.w) {
+		++elidedCommands;
+	} else {
+		writeHeader(Code::setColumn, rect.w - 1);
+		writeVar(rect.x);
+	}
+	if(known && rect.y == committed.y && rect.h == committed.h) {
+		++elidedCommands;
+	} else {
+		writeHeader(Code::setRow, rect.h - 1);
+		writeVar(rect.y);
+	}
+#ifdef ENABLE_GRAPHICS_DL_STATS
+	if(elidedCommands - elided < 2) {
+		++stats.windowChanges;
+	}
+	stats.elidedCommands += elidedCommands - elided;
+#else
+	(void)elided;
+#endif
+	committed = rect;
 	addrWindow = rect;
 }
 
@@ -307,4 +413,369 @@ bool DisplayList::readEntry(Entry& entry)
 	return true;
 }
 
+#ifdef ENABLE_GRAPHICS_DL_STATS
+
+DisplayList::Stats DisplayList::stats{};
+
+/*
+ * Account for list content by reading it back, as for DisplayListRecorder.
+ * This keeps the overhead out of the code which builds the list.
+ */
+void DisplayList::updateStats()
+{
+	++stats.lists;
+	stats.listBytes += size;
+
+	auto savedOffset = offset;
+	offset = 0;
+	Entry entry;
+	while(readEntry(entry)) {
+		auto& cs = stats.codes[unsigned(entry.code)];
+		++cs.count;
+		switch(entry.code) {
+		case Code::setColumn:
+		case Code::setRow:
+			// Length is window size, display gets command byte plus start and end values
+			cs.sent += 5;
+			break;
+		case Code::repeat:
+			cs.bytes += entry.length;
+			cs.sent += entry.length * entry.repeats;
+			break;
+		default:
+			cs.bytes += entry.length;
+			cs.sent += entry.length;
+		}
+	}
+	offset = savedOffset;
+}
+
+void DisplayList::Stats::write(MetaWriter& meta) const
+{
+	meta.write("lists", lists);
+	meta.write("listBytes", listBytes);
+	meta.write("windowChanges", windowChanges);
+	meta.write("elidedCommands", elidedCommands);
+	for(unsigned i = 0; i < codeCount; ++i) {
+		if(codes[i].count != 0) {
+			meta.write(toString(Code(i)), codes[i]);
+		}
+	}
+}
+
+#endif
+
+/* DisplayListRecorder */
+
+DisplayListRecorder::DisplayListRecorder(Print& out, Mode mode, PixelFormat pixelFormat) : out(out), mode(mode)
+{
+	if(mode == Mode::exact) {
+		Header header{Header::magicValue, Header::currentVersion, pixelFormat, 0};
+		write(&header, sizeof(header));
+	}
+}
+
+void DisplayListRecorder::write(const void* data, size_t length)
+{
+	if(length == 0) {
+		return;
+	}
+	if(out.write(static_cast<const uint8_t*>(data), length) != length) {
+		valid = false;
+	}
+	size += length;
+}
+
+void DisplayListRecorder::writeVar(uint16_t value)
+{
+	uint8_t buf[2];
+	if(value >= 0x80) {
+		buf[0] = (value >> 8) | 0x80;
+		buf[1] = value & 0xff;
+		write(buf, 2);
+	} else {
+		buf[0] = value;
+		write(buf, 1);
+	}
+}
+
+void DisplayListRecorder::writeHeader(DisplayList::Code code, uint16_t length)
+{
+	using Header = DisplayList::Header;
+	Header hdr{{code, uint8_t(std::min(length, uint16_t(Header::lenMax)))}};
+	write(&hdr.u8, 1);
+	if(length >= Header::lenMax) {
+		writeVar(length);
+	}
+}
+
+bool DisplayListRecorder::record(DisplayList& list, Point origin)
+{
+	if(!valid) {
+		return false;
+	}
+
+	auto savedOffset = list.offset;
+	list.offset = 0;
+	if(mode == Mode::exact) {
+		recordExact(list);
+	} else {
+		recordRelocatable(list, origin);
+	}
+	list.offset = savedOffset;
+	++listCount;
+	return valid;
+}
+
+void DisplayListRecorder::recordRelocatable(DisplayList& list, Point origin)
+{
+	using Code = DisplayList::Code;
+
+	DisplayList::Entry entry;
+	while(valid && list.readEntry(entry)) {
+		switch(entry.code) {
+		case Code::command:
+		case Code::delay:
+			// Device-specific, not part of the picture
+			break;
+		case Code::setColumn:
+			window.x = entry.value - origin.x;
+			window.w = entry.length + 1;
+			windowChanged = true;
+			writeHeader(entry.code, entry.length);
+			writeVar(window.x);
+			break;
+		case Code::setRow:
+			window.y = entry.value - origin.y;
+			window.h = entry.length + 1;
+			windowChanged = true;
+			writeHeader(entry.code, entry.length);
+			writeVar(window.y);
+			break;
+		case Code::writeStart:
+		case Code::writeData:
+			addWindowToBounds();
+			writeHeader(entry.code, entry.length);
+			write(entry.data, entry.length);
+			break;
+		case Code::writeDataBuffer:
+			addWindowToBounds();
+			writeHeader(Code::writeData, entry.length);
+			write(entry.data, entry.length);
+			break;
+		case Code::repeat:
+			addWindowToBounds();
+			if(entry.length > RecordingObject::maxRepeatLength) {
+				writeRepeatAsData(entry);
+				break;
+			}
+			writeHeader(entry.code, entry.length);
+			writeVar(entry.repeats);
+			write(entry.data, entry.length);
+			break;
+		default:
+			debug_w("[DL] Cannot record '%s'", DisplayList::toString(entry.code).c_str());
+			valid = false;
+		}
+	}
+}
+
+/*
+ * Playback only buffers short repeated blocks, so longer ones are expanded into data entries
+ * each holding as many complete copies as will fit.
+ */
+void DisplayListRecorder::writeRepeatAsData(const DisplayList::Entry& entry)
+{
+	constexpr uint16_t maxDataLength{0x7fff};
+	uint16_t repeats = entry.repeats;
+	while(repeats != 0) {
+		uint16_t count = std::min(repeats, uint16_t(maxDataLength / entry.length));
+		writeHeader(DisplayList::Code::writeData, count * entry.length);
+		for(unsigned i = 0; i < count; ++i) {
+			write(entry.data, entry.length);
+		}
+		repeats -= count;
+	}
+}
+
+/*
+ * Either axis of the window may be changed on its own, so bounds are updated
+ * when data is written rather than on every setColumn/setRow.
+ */
+void DisplayListRecorder::addWindowToBounds()
+{
+	if(windowChanged) {
+		bounds += window;
+		windowChanged = false;
+	}
+}
+
+void DisplayListRecorder::recordExact(DisplayList& list)
+{
+	using Code = DisplayList::Code;
+	using Header = DisplayList::Header;
+
+	DisplayList::Entry entry;
+	for(;;) {
+		auto start = list.offset;
+		if(!list.readEntry(entry)) {
+			break;
+		}
+		auto raw = &list.buffer[start];
+		auto rawLength = list.offset - start;
+		switch(entry.code) {
+		case Code::writeDataBuffer: {
+			Header hdr{.u8 = raw[0]};
+			hdr.code = Code::writeData;
+			write(&hdr.u8, 1);
+			write(&raw[1], rawLength - 1 - sizeof(void*));
+			write(entry.data, entry.length);
+			break;
+		}
+		case Code::readStart:
+		case Code::read:
+			write(raw, rawLength - sizeof(void*));
+			break;
+		case Code::callback: {
+			Header hdr{.u8 = raw[0]};
+			size_t hdrLength{1};
+			if(hdr.len == Header::lenMax) {
+				hdrLength += (raw[1] & 0x80) ? 2 : 1;
+			}
+			write(raw, hdrLength);
+			write(entry.data, entry.length);
+			break;
+		}
+		default:
+			write(raw, rawLength);
+		}
+	}
+
+	// End of list
+	Header hdr{{Code::none, 0}};
+	write(&hdr.u8, 1);
+}
+
+bool DisplayListRecorder::readHeader(IDataSourceStream& in, Header& header)
+{
+	if(in.readBytes(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)) {
+		return false;
+	}
+	if(header.magic != Header::magicValue) {
+		debug_e("[DL] Not an exact recording");
+		return false;
+	}
+	if(header.version != Header::currentVersion) {
+		debug_e("[DL] Recording version %u not supported", header.version);
+		return false;
+	}
+	return true;
+}
+
+bool DisplayListRecorder::load(IDataSourceStream& in, DisplayList& list, void* readBuffer, DisplayList::Callback callback)
+{
+	using Code = DisplayList::Code;
+	using Header = DisplayList::Header;
+
+	list.reset();
+
+	// Copy data from stream to list
+	auto copy = [&](uint16_t length) -> bool {
+		if(!list.require(length)) {
+			debug_e("[DL] List too small");
+			return false;
+		}
+		auto dst = reinterpret_cast<char*>(&list.buffer[list.size]);
+		if(in.readBytes(dst, length) != length) {
+			return false;
+		}
+		list.size += length;
+		return true;
+	};
+
+	// Copy variable-length value, returning its value
+	auto copyVar = [&](uint16_t& value) -> bool {
+		if(!copy(1)) {
+			return false;
+		}
+		value = list.buffer[list.size - 1];
+		if(value & 0x80) {
+			if(!copy(1)) {
+				return false;
+			}
+			value = ((value & 0x7f) << 8) | list.buffer[list.size - 1];
+		}
+		return true;
+	};
+
+	for(;;) {
+		if(!copy(1)) {
+			return false;
+		}
+		Header hdr{.u8 = list.buffer[list.size - 1]};
+		if(hdr.code == Code::none) {
+			// Drop terminator
+			--list.size;
+			return true;
+		}
+		uint16_t length = hdr.len;
+		if(length == Header::lenMax && !copyVar(length)) {
+			return false;
+		}
+
+		uint16_t value;
+		switch(hdr.code) {
+		case Code::command:
+			if(!copy(1 + length)) {
+				return false;
+			}
+			break;
+		case Code::repeat:
+			if(!copyVar(value) || !copy(length)) {
+				return false;
+			}
+			break;
+		case Code::setColumn:
+		case Code::setRow:
+			if(!copyVar(value)) {
+				return false;
+			}
+			break;
+		case Code::writeStart:
+		case Code::writeData:
+			if(!copy(length)) {
+				return false;
+			}
+			break;
+		case Code::readStart:
+		case Code::read:
+			if(!list.require(sizeof(readBuffer))) {
+				return false;
+			}
+			list.write(&readBuffer, sizeof(readBuffer));
+			break;
+		case Code::callback:
+			if(!list.require(sizeof(callback) + 3)) {
+				return false;
+			}
+			list.write(&callback, sizeof(callback));
+			if(length != 0) {
+				list.size = ALIGNUP4(list.size);
+				if(!copy(length)) {
+					return false;
+				}
+			}
+			break;
+		case Code::delay:
+			if(!copy(1)) {
+				return false;
+			}
+			break;
+		default:
+			debug_e("[DL] Bad recorded entry %s", DisplayList::toString(hdr.code).c_str());
+			return false;
+		}
+	}
+}
+
 } // namespace Graphics
@@ -172,31 +172,33 @@ Object* Reader::readObject()
 			--state.reg.y2;
 			break;
 		case Command::setPixel:
-			return new PointObject(getBrush(), state.reg.pt2());
+			return new (RenderArena::transient) PointObject(getBrush(), state.reg.pt2());
 		case Command::line:
-			return new LineObject(getPen(), state.reg.pt1(), state.reg.pt2());
+			return new (RenderArena::transient) LineObject(getPen(), state.reg.pt1(), state.reg.pt2());
 		case Command::lineto: {
-			auto obj = new LineObject(getPen(), state.reg.pt1(), state.reg.pt2());
+			auto obj = new (RenderArena::transient) LineObject(getPen(), state.reg.pt1(), state.reg.pt2());
 			state.reg.x1 = state.reg.x2;
 			state.reg.y1 = state.reg.y2;
 			return obj;
 		}
 		case Command::drawArc:
-			return new ArcObject(getPen(), state.reg.rect(), state.reg.startAngle, state.reg.endAngle());
+			return new (RenderArena::transient)
+				ArcObject(getPen(), state.reg.rect(), state.reg.startAngle, state.reg.endAngle());
 		case Command::fillArc:
-			return new FilledArcObject(getBrush(), state.reg.rect(), state.reg.startAngle, state.reg.endAngle());
+			return new (RenderArena::transient)
+				FilledArcObject(getBrush(), state.reg.rect(), state.reg.startAngle, state.reg.endAngle());
 		case Command::drawRect:
-			return new RectObject(getPen(), state.reg.rect(), state.reg.radius);
+			return new (RenderArena::transient) RectObject(getPen(), state.reg.rect(), state.reg.radius);
 		case Command::fillRect:
-			return new FilledRectObject(getBrush(), state.reg.rect(), state.reg.radius);
+			return new (RenderArena::transient) FilledRectObject(getBrush(), state.reg.rect(), state.reg.radius);
 		case Command::drawCircle:
-			return new CircleObject(getPen(), state.reg.pt2(), state.reg.radius);
+			return new (RenderArena::transient) CircleObject(getPen(), state.reg.pt2(), state.reg.radius);
 		case Command::fillCircle:
-			return new FilledCircleObject(getBrush(), state.reg.pt2(), state.reg.radius);
+			return new (RenderArena::transient) FilledCircleObject(getBrush(), state.reg.pt2(), state.reg.radius);
 		case Command::drawEllipse:
-			return new EllipseObject(getPen(), state.reg.rect());
+			return new (RenderArena::transient) EllipseObject(getPen(), state.reg.rect());
 		case Command::fillEllipse:
-			return new FilledEllipseObject(getBrush(), state.reg.rect());
+			return new (RenderArena::transient) FilledEllipseObject(getBrush(), state.reg.rect());
 		case Command::drawText: {
 			auto text = findAsset<TextAsset>(state.reg.textId);
 			if(text == nullptr) {
@@ -207,7 +209,7 @@ Object* Reader::readObject()
 				return nullptr;
 			}
 			auto font = findAsset<Font>(state.reg.fontId) ?: &lcdFont;
-			auto obj = new TextObject(state.reg.rect());
+			auto obj = new (RenderArena::transient) TextObject(state.reg.rect());
 			obj->addText(*text);
 			auto& typeface = *font->getFace(state.reg.style);
 			obj->addFont(typeface, {/* TODO: SCALE*/}, state.reg.style);
@@ -40,13 +40,18 @@ void ImageSurface::commit(uint16_t length)
 bool ImageSurface::writePixels(const void* data, uint16_t length)
 {
 	addressWindow.setMode(AddressWindow::Mode::write);
-	auto rowoffset = addressWindow.bounds.y * imageSize.w;
 	auto src = static_cast<const uint8_t*>(data);
 	uint16_t pixelCount = length / bytesPerPixel;
 	while(pixelCount > 0) {
 		auto count = std::min(pixelCount, uint16_t(addressWindow.bounds.w - addressWindow.column));
-		write((rowoffset + addressWindow.left()) * bytesPerPixel, src, count * bytesPerPixel);
-		rowoffset += imageSize.w;
+		// Window may extend beyond image, e.g. when rendering into a tile, so clip each row
+		int y = addressWindow.bounds.y;
+		int x = addressWindow.bounds.x + addressWindow.column;
+		int x0 = std::max(x, 0);
+		int x1 = std::min(x + count, int(imageSize.w));
+		if(y >= 0 && y < imageSize.h && x1 > x0) {
+			write((y * imageSize.w + x0) * bytesPerPixel, src + (x0 - x) * bytesPerPixel, (x1 - x0) * bytesPerPixel);
+		}
 		src += count * bytesPerPixel;
 		pixelCount -= count;
 		uint16_t seekres = addressWindow.seek(count);
@@ -75,10 +80,10 @@ bool ImageSurface::blockFill(const void* data, uint16_t length, uint32_t repeat)
 
 bool ImageSurface::setPixel(PackedColor color, Point pt)
 {
-	uint32_t offset = (pt.x + (pt.y * imageSize.w)) * bytesPerPixel;
-	if(offset + bytesPerPixel >= imageBytes) {
+	if(!Rect(imageSize).contains(pt)) {
 		return true;
 	}
+	uint32_t offset = (pt.x + (pt.y * imageSize.w)) * bytesPerPixel;
 	if(color.alpha < 255) {
 		PackedColor cur;
 		read(offset, &cur, bytesPerPixel);
@@ -97,10 +102,23 @@ int ImageSurface::readDataBuffer(ReadBuffer& buffer, ReadStatus* status, ReadCal
 	Location loc{imageSize};
 	while(bufPixels != 0) {
 		auto width = std::min(size_t(addressWindow.bounds.w - addressWindow.column), bufPixels);
-		loc.source = addressWindow.bounds;
-		loc.source.x += addressWindow.column;
-		auto len = image.readPixels(loc, buffer.format, bufptr, width);
-		bufptr += len;
+		// Pixels outside the image read as zero
+		int y = addressWindow.bounds.y;
+		int x = addressWindow.bounds.x + addressWindow.column;
+		int x0 = std::max(x, 0);
+		int x1 = std::min(x + int(width), int(imageSize.w));
+		if(y < 0 || y >= imageSize.h || x1 <= x0) {
+			x0 = x1 = x + width;
+		}
+		memset(bufptr, 0, (x0 - x) * bpp);
+		bufptr += (x0 - x) * bpp;
+		if(x1 > x0) {
+			loc.source = Rect(x0, y, x1 - x0, 1);
+			bufptr += image.readPixels(loc, buffer.format, bufptr, x1 - x0);
+		}
+		auto trailing = x + width - x1;
+		memset(bufptr, 0, trailing * bpp);
+		bufptr += trailing * bpp;
 		bufPixels -= width;
 		addressWindow.seek(width);
 	}
@@ -110,8 +128,10 @@ int ImageSurface::readDataBuffer(ReadBuffer& buffer, ReadStatus* status, ReadCal
 		status->bytesRead = bytesRead;
 		status->readComplete = true;
 	}
-	if(callback) {
-		System.queueCallback([&]() { callback(buffer, bytesRead, param); });
+	// As with display surfaces, there's no callback if nothing was read
+	if(callback && bytesRead != 0) {
+		auto readBuffer = &buffer;
+		System.queueCallback([=]() { callback(*readBuffer, bytesRead, param); });
 	}
 
 	return bytesRead / bpp;
@@ -120,16 +140,22 @@ int ImageSurface::readDataBuffer(ReadBuffer& buffer, ReadStatus* status, ReadCal
 bool ImageSurface::fillRect(PackedColor color, const Rect& rect)
 {
 	Rect r = intersect(rect, imageSize);
+	if(!r) {
+		return true;
+	}
 	setAddrWindow(r);
 
 	auto offset = (r.x + r.y * imageSize.w) * bytesPerPixel;
 	size_t rowBytes = r.w * bytesPerPixel;
 	size_t stride = imageSize.w * bytesPerPixel;
+	uint8_t rowBuffer[rowBytes];
+	bool opaque = (color.alpha == 255);
+	if(opaque) {
+		// Same content for every row
+		writeColor(rowBuffer, color, pixelFormat, r.w);
+	}
 	for(unsigned y = 0; y < r.h; ++y, offset += stride) {
-		uint8_t rowBuffer[rowBytes];
-		if(color.alpha == 255) {
-			writeColor(rowBuffer, color, pixelFormat, r.w);
-		} else {
+		if(!opaque) {
 			read(offset, rowBuffer, rowBytes);
 			BlendAlpha::blend(pixelFormat, color, rowBuffer, rowBytes);
 		}
@@ -161,6 +187,45 @@ void MemoryImageSurface::write(uint32_t offset, const void* data, size_t length)
 	}
 }
 
+/* IndexedImageSurface */
+
+void IndexedImageSurface::read(uint32_t offset, void* buffer, size_t length)
+{
+	assert(offset + length <= imageBytes);
+	auto& img = static_cast<IndexedImageObject&>(image);
+	img.getPixels(offset / bytesPerPixel, static_cast<uint8_t*>(buffer), length / bytesPerPixel);
+}
+
+void IndexedImageSurface::write(uint32_t offset, const void* data, size_t length)
+{
+	if(offset > imageBytes) {
+		return;
+	}
+	length = std::min(length, size_t(imageBytes - offset));
+
+	auto& img = static_cast<IndexedImageObject&>(image);
+	auto pixel = offset / bytesPerPixel;
+	auto count = length / bytesPerPixel;
+	if(blend == nullptr) {
+		img.setPixels(pixel, static_cast<const uint8_t*>(data), count);
+		return;
+	}
+
+	// Blend in chunks, each a whole number of pixels for any format up to 4 bytes per pixel
+	uint8_t buffer[96];
+	auto src = static_cast<const uint8_t*>(data);
+	while(count != 0) {
+		auto n = std::min(count, sizeof(buffer) / bytesPerPixel);
+		auto len = n * bytesPerPixel;
+		img.getPixels(pixel, buffer, n);
+		blend->transform(pixelFormat, src, buffer, len);
+		img.setPixels(pixel, buffer, n);
+		pixel += n;
+		count -= n;
+		src += len;
+	}
+}
+
 /* FileImageSurface */
 
 void FileImageSurface::read(uint32_t offset, void* buffer, size_t length)
@@ -37,27 +37,9 @@ struct ReadPixelInfo {
 	void readComplete()
 	{
 		if(buffer.format != PixelFormat::RGB24) {
-			auto srcptr = &buffer.data[buffer.offset];
-			auto dstptr = srcptr;
-			if(buffer.format == PixelFormat::RGB565) {
-				for(size_t i = 0; i < bytesToRead; i += READ_PIXEL_SIZE) {
-					PixelBuffer buf;
-					buf.rgb565.r = *srcptr++ >> 3;
-					buf.rgb565.g = *srcptr++ >> 2;
-					buf.rgb565.b = *srcptr++ >> 3;
-					*dstptr++ = buf.u8[1];
-					*dstptr++ = buf.u8[0];
-				}
-			} else {
-				for(size_t i = 0; i < bytesToRead; i += READ_PIXEL_SIZE) {
-					PixelBuffer buf;
-					buf.rgb24.r = *srcptr++;
-					buf.rgb24.g = *srcptr++;
-					buf.rgb24.b = *srcptr++;
-					dstptr += writeColor(dstptr, buf.color, buffer.format);
-				}
-			}
-			bytesToRead = dstptr - &buffer.data[buffer.offset];
+			auto ptr = &buffer.data[buffer.offset];
+			auto converter = getConverter(PixelFormat::RGB24, buffer.format);
+			bytesToRead = converter(ptr, ptr, bytesToRead / READ_PIXEL_SIZE);
 		}
 		if(status != nullptr) {
 			*status = ReadStatus{bytesToRead, buffer.format, true};
@@ -200,6 +182,21 @@ bool MipiDisplay::scroll(int16_t y)
 MipiSurface::MipiSurface(MipiDisplay& display, size_t bufferSize)
 	: display(display), displayList(MipiDisplay::commands, display.getAddressWindow(), bufferSize)
 {
+	setRunLengthEncoding(display.getRunLengthEncoding());
+}
+
+void MipiSurface::reset()
+{
+	/*
+	 * Record lists only once executed: data for writeDataBuffer entries
+	 * may be filled in by read callbacks during execution.
+	 */
+	auto recorder = display.getRecorder();
+	if(presented && recorder != nullptr && !displayList.isBusy()) {
+		recorder->record(displayList, display.getAddrOffset());
+	}
+	presented = false;
+	displayList.reset();
 }
 
 /*
@@ -310,6 +307,7 @@ bool MipiSurface::present(PresentCallback callback, void* param)
 		return false;
 	}
 	display.execute(displayList, callback, param);
+	presented = true;
 	return true;
 }
 
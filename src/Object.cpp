@@ -101,11 +101,51 @@ Renderer* FilledRectObject::createRenderer(const Location& location) const
 
 /* LineObject */
 
+namespace
+{
+Rect getLineBounds(Rect r, uint16_t width, LineCap cap)
+{
+	if(width <= 1) {
+		return r;
+	}
+
+	switch(cap) {
+	case LineCap::Round:
+		r.inflate(width / 2);
+		break;
+	case LineCap::Square:
+		// Corners extend by up to half the width times root 2
+		r.inflate((width * 3 + 3) / 4);
+		break;
+	case LineCap::None:
+	default:
+		// Pen width extends lines to the right and downwards
+		r.w += width - 1;
+		r.h += width - 1;
+	}
+	return r;
+}
+
+} // namespace
+
 Renderer* LineObject::createRenderer(const Location& location) const
 {
+	if(pen.width > 1) {
+		// Horizontal and vertical lines without caps are just rectangles
+		if(cap != LineCap::None || (pt1.x != pt2.x && pt1.y != pt2.y)) {
+			return new ThickLineRenderer(location, pen, pt1, pt2, cap);
+		}
+	} else if(antialias && pen.isSolid()) {
+		return new AntialiasedLineRenderer(location, pen, pt1, pt2);
+	}
 	return new LineRenderer(location, pen, pt1, pt2);
 }
 
+Rect LineObject::calculateBounds() const
+{
+	return getLineBounds(Rect(pt1, pt2), pen.width, cap);
+}
+
 /* PolylineObject */
 
 Renderer* PolylineObject::createRenderer(const Location& location) const
@@ -113,10 +153,46 @@ Renderer* PolylineObject::createRenderer(const Location& location) const
 	return new PolylineRenderer(location, *this);
 }
 
+Rect PolylineObject::calculateBounds() const
+{
+	if(numPoints == 0) {
+		return Rect{};
+	}
+	Point pt1 = points[0];
+	Point pt2 = pt1;
+	for(unsigned i = 1; i < numPoints; ++i) {
+		auto& pt = points[i];
+		pt1.x = std::min(pt1.x, pt.x);
+		pt1.y = std::min(pt1.y, pt.y);
+		pt2.x = std::max(pt2.x, pt.x);
+		pt2.y = std::max(pt2.y, pt.y);
+	}
+	return getLineBounds(Rect(pt1, pt2), pen.width, cap);
+}
+
+/* FilledPolygonObject */
+
+Renderer* FilledPolygonObject::createRenderer(const Location& location) const
+{
+	return new FilledPolygonRenderer(location, *this);
+}
+
+Rect FilledPolygonObject::calculateBounds() const
+{
+	Rect r{};
+	for(unsigned i = 0; i < numPoints; ++i) {
+		r += Rect(points[i], 1, 1);
+	}
+	return r;
+}
+
 /* CircleObject */
 
 Renderer* CircleObject::createRenderer(const Location& location) const
 {
+	if(antialias && pen.width <= 1 && pen.isSolid() && radius > 1) {
+		return new AntialiasedEllipseRenderer(location, *this);
+	}
 	if(pen.width <= 1 and !pen.isTransparent()) {
 		return new CircleRenderer(location, *this);
 	}
@@ -138,6 +214,9 @@ Renderer* FilledCircleObject::createRenderer(const Location& location) const
 
 Renderer* EllipseObject::createRenderer(const Location& location) const
 {
+	if(antialias && pen.width <= 1 && pen.isSolid() && rect.w > 2 && rect.h > 2) {
+		return new AntialiasedEllipseRenderer(location, pen, rect);
+	}
 	return new EllipseRenderer(location, pen, rect);
 }
 
@@ -174,6 +253,9 @@ Renderer* FilledArcObject::createRenderer(const Location& location) const
 
 Renderer* ImageObject::createRenderer(const Location& location) const
 {
+	if(getAlphaMode() != AlphaMode::none) {
+		return new ImageCopyRenderer(location, *this, nullptr);
+	}
 	return new ImageRenderer(location, *this);
 }
 
@@ -184,6 +266,22 @@ Renderer* TextObject::createRenderer(const Location& location) const
 	return new TextRenderer(location, *this);
 }
 
+Rect TextObject::calculateBounds() const
+{
+	// Runs are positioned relative to bounds but aren't clipped to it
+	Rect r = bounds;
+	const FontElement* font{nullptr};
+	for(auto& elem : elements) {
+		if(elem.kind == Element::Kind::Font) {
+			font = static_cast<const FontElement*>(&elem);
+		} else if(elem.kind == Element::Kind::Run && font != nullptr) {
+			auto& run = static_cast<const RunElement&>(elem);
+			r += Rect(bounds.topLeft() + run.pos, run.width, font->height());
+		}
+	}
+	return r;
+}
+
 /* SurfaceObject */
 
 void SurfaceObject::write(MetaWriter& meta) const
@@ -212,6 +310,13 @@ Renderer* ScrollObject::createRenderer(const Location& location) const
 	return new ScrollRenderer(location, *this);
 }
 
+/* RecordingObject */
+
+Renderer* RecordingObject::createRenderer(const Location& location) const
+{
+	return new RecordingRenderer(location, *this);
+}
+
 /* SceneObject */
 
 Renderer* SceneObject::createRenderer(const Location& location) const
@@ -337,26 +442,43 @@ size_t BitmapObject::readPixels(const Location& loc, PixelFormat format, void* b
 
 /* RawImageObject */
 
-size_t RawImageObject::readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const
+size_t RawImageObject::readPixelData(const Location& loc, PixelFormat format, void* buffer, uint8_t* alpha,
+									 uint16_t width) const
 {
 	auto pos = loc.sourcePos();
 	auto bpp = getBytesPerPixel(pixelFormat);
-	uint32_t offset = ((pos.y * imageSize.w) + pos.x) * bpp;
+	auto stride = getStride();
+	uint32_t offset = ((pos.y * imageSize.w) + pos.x) * stride;
 	seek(offset);
-	if(format == pixelFormat) {
+	if(format == pixelFormat && stride == bpp && alpha == nullptr) {
 		size_t count = width * bpp;
 		read(buffer, count);
 		return count;
 	}
 
+	// Alpha is either the last pixel byte (BGRA32) or follows the pixel
+	auto alphaOffset = (stride == bpp) ? bpp - 1 : bpp;
+
 	// Fall back to format conversion
+	auto converter = getConverter(pixelFormat, format);
 	auto dstptr = static_cast<uint8_t*>(buffer);
 	while(width != 0) {
 		constexpr uint16_t bufPixels{32};
-		uint8_t buf[bufPixels * bpp];
+		uint8_t buf[bufPixels * stride];
 		auto numPixels = std::min(width, bufPixels);
-		read(&buf, numPixels * bpp);
-		dstptr += convert(buf, pixelFormat, dstptr, format, numPixels);
+		read(&buf, numPixels * stride);
+		if(alpha != nullptr) {
+			for(unsigned i = 0; i < numPixels; ++i) {
+				*alpha++ = buf[i * stride + alphaOffset];
+			}
+		}
+		if(stride != bpp) {
+			// Strip alpha values
+			for(unsigned i = 1; i < numPixels; ++i) {
+				memmove(&buf[i * bpp], &buf[i * stride], bpp);
+			}
+		}
+		dstptr += converter(buf, dstptr, numPixels);
 		width -= numPixels;
 	}
 	return dstptr - static_cast<uint8_t*>(buffer);
@@ -386,6 +508,137 @@ Surface* MemoryImageObject::createSurface(const Blend* blend, size_t bufferSize)
 	return new MemoryImageSurface(*this, pixelFormat, blend, bufferSize ?: 512U, imageData);
 }
 
+/* IndexedImageObject */
+
+IndexedImageObject::IndexedImageObject(PixelFormat format, Size size, uint8_t bitsPerPixel, const Color* palette)
+	: ImageObject(size), pixelFormat(format), bitsPerPixel(bitsPerPixel), pixelMask((1U << bitsPerPixel) - 1),
+	  stride((size.w * bitsPerPixel + 7) / 8)
+{
+	if(bitsPerPixel != 1 && bitsPerPixel != 2 && bitsPerPixel != 4 && bitsPerPixel != 8) {
+		debug_e("[IMG] Invalid bitsPerPixel %u", bitsPerPixel);
+		return;
+	}
+
+	size_t imageBytes = stride * size.h;
+	auto paletteSize = getPaletteSize();
+	size_t paletteBytes = paletteSize * (sizeof(Color) + sizeof(PackedColor));
+	constexpr size_t minFreeHeap{8192};
+	auto heapFree = system_get_free_heap_size();
+	if(heapFree < minFreeHeap + imageBytes + paletteBytes) {
+		debug_w("[IMG] Not enough memory for %s image", size.toString().c_str());
+		return;
+	}
+
+	this->palette.reset(new Color[paletteSize]);
+	packedPalette.reset(new PackedColor[paletteSize]);
+	for(unsigned i = 0; i < paletteSize; ++i) {
+		this->palette[i] = palette[i];
+		packedPalette[i] = pack(palette[i], format);
+	}
+
+	imageData.reset(new uint8_t[imageBytes]{});
+	debug_i("[IMG] %p, %s x %u-bit created, heap %u -> %u", imageData.get(), size.toString().c_str(), bitsPerPixel,
+			heapFree, system_get_free_heap_size());
+}
+
+Surface* IndexedImageObject::createSurface(const Blend* blend, size_t bufferSize)
+{
+	return new IndexedImageSurface(*this, blend, bufferSize ?: 512U);
+}
+
+void IndexedImageObject::setPaletteColor(uint8_t index, Color color)
+{
+	if(index < getPaletteSize()) {
+		palette[index] = color;
+		packedPalette[index] = pack(color, pixelFormat);
+	}
+}
+
+size_t IndexedImageObject::readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const
+{
+	auto pos = loc.sourcePos();
+	auto bpp = getBytesPerPixel(format);
+	auto dstptr = static_cast<uint8_t*>(buffer);
+	for(unsigned i = 0; i < width; ++i) {
+		auto index = getIndex(pos.x + i, pos.y);
+		auto color = (format == pixelFormat) ? packedPalette[index] : pack(palette[index], format);
+		memcpy(dstptr, &color, bpp);
+		dstptr += bpp;
+	}
+	return width * bpp;
+}
+
+/*
+ * Find palette entry for a colour.
+ * Exact matches are compared in packed format, otherwise the nearest entry is used.
+ */
+uint8_t IndexedImageObject::findColor(PackedColor color) const
+{
+	// Unused bytes (e.g. the third byte for RGB565) are undefined so must be ignored
+	auto bpp = getBytesPerPixel(pixelFormat);
+	uint32_t mask = (bpp >= 3) ? 0xffffff : (1U << (bpp * 8)) - 1;
+	auto equal = [mask](PackedColor c1, PackedColor c2) { return ((c1.value ^ c2.value) & mask) == 0; };
+
+	if(equal(packedPalette[lastIndex], color)) {
+		return lastIndex;
+	}
+
+	auto paletteSize = getPaletteSize();
+	for(unsigned i = 0; i < paletteSize; ++i) {
+		if(equal(packedPalette[i], color)) {
+			lastIndex = i;
+			return i;
+		}
+	}
+
+	PixelBuffer buf{.packed = color};
+	buf = unpack(buf, pixelFormat);
+	unsigned minDistance = ~0U;
+	for(unsigned i = 0; i < paletteSize; ++i) {
+		PixelBuffer entry{palette[i]};
+		int dr = entry.bgra32.r - buf.bgra32.r;
+		int dg = entry.bgra32.g - buf.bgra32.g;
+		int db = entry.bgra32.b - buf.bgra32.b;
+		unsigned distance = dr * dr + dg * dg + db * db;
+		if(distance < minDistance) {
+			minDistance = distance;
+			lastIndex = i;
+		}
+	}
+	return lastIndex;
+}
+
+void IndexedImageObject::getPixels(uint32_t pixel, uint8_t* buffer, size_t count) const
+{
+	auto bpp = getBytesPerPixel(pixelFormat);
+	uint16_t x = pixel % imageSize.w;
+	uint16_t y = pixel / imageSize.w;
+	for(; count != 0; --count, buffer += bpp) {
+		auto color = packedPalette[getIndex(x, y)];
+		memcpy(buffer, &color, bpp);
+		if(++x == imageSize.w) {
+			x = 0;
+			++y;
+		}
+	}
+}
+
+void IndexedImageObject::setPixels(uint32_t pixel, const uint8_t* data, size_t count)
+{
+	auto bpp = getBytesPerPixel(pixelFormat);
+	uint16_t x = pixel % imageSize.w;
+	uint16_t y = pixel / imageSize.w;
+	for(; count != 0; --count, data += bpp) {
+		PackedColor color{};
+		memcpy(&color, data, bpp);
+		setIndex(x, y, findColor(color));
+		if(++x == imageSize.w) {
+			x = 0;
+			++y;
+		}
+	}
+}
+
 /* FileImageObject */
 
 Surface* FileImageObject::createSurface(size_t bufferSize)
@@ -459,4 +712,20 @@ void DrawingObject::write(MetaWriter& meta) const
 	meta.endArray();
 }
 
+Rect DrawingObject::calculateBounds() const
+{
+	Rect r{};
+	Drawing::Reader reader(*this);
+	Object* obj;
+	while((obj = reader.readObject()) != nullptr) {
+		auto objBounds = obj->getBounds();
+		delete obj;
+		if(!objBounds) {
+			return Rect{};
+		}
+		r += objBounds;
+	}
+	return r;
+}
+
 } // namespace Graphics
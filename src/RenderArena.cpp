@@ -0,0 +1,129 @@
+/****
+ * RenderArena.cpp
+ *
+ * Copyright 2021 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the Sming-Graphics Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * @author: May 2021 - mikee47 <mike@sillyhouse.net>
+ *
+ ****/
+
+#include "include/Graphics/RenderArena.h"
+#include <debug_progmem.h>
+#include <algorithm>
+#include <cassert>
+
+namespace Graphics
+{
+#ifdef ARCH_HOST
+thread_local RenderArena* RenderArena::current;
+#else
+RenderArena* RenderArena::current;
+#endif
+RenderArena* RenderArena::first;
+
+RenderArena::RenderArena(size_t size) : next(first), capacity(std::min(size, size_t(0xffff)))
+{
+	if(capacity != 0) {
+		buffer.reset(new uint8_t[capacity]);
+	}
+	first = this;
+}
+
+RenderArena::~RenderArena()
+{
+	if(!isEmpty()) {
+		debug_e("[ARENA] Destroyed with %u bytes in use", top);
+	}
+	for(auto p = &first; *p != nullptr; p = &(*p)->next) {
+		if(*p == this) {
+			*p = next;
+			break;
+		}
+	}
+	if(current == this) {
+		current = nullptr;
+	}
+}
+
+void* RenderArena::allocate(size_t size)
+{
+	size = sizeof(Header) + (size + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+	if(top + size > capacity) {
+		++overflowCount;
+		return nullptr;
+	}
+
+	auto hdr = block(top);
+	hdr->prev = last;
+	hdr->released = false;
+	last = top;
+	top += size;
+	peak = std::max(peak, top);
+	return hdr + 1;
+}
+
+void RenderArena::release(void* ptr)
+{
+	assert(contains(ptr));
+	auto hdr = static_cast<Header*>(ptr) - 1;
+	hdr->released = true;
+
+	// Reclaim released blocks from the top of the stack
+	while(top != 0) {
+		hdr = block(last);
+		if(!hdr->released) {
+			break;
+		}
+		top = last;
+		last = hdr->prev;
+	}
+}
+
+void RenderArena::reset()
+{
+	if(!isEmpty()) {
+		debug_w("[ARENA] Reset with %u bytes in use", top);
+		return;
+	}
+	peak = 0;
+	overflowCount = 0;
+}
+
+void* RenderArena::alloc(size_t size)
+{
+	if(current != nullptr) {
+		auto ptr = current->allocate(size);
+		if(ptr != nullptr) {
+			return ptr;
+		}
+	}
+	return ::operator new(size);
+}
+
+void RenderArena::free(void* ptr)
+{
+	if(ptr == nullptr) {
+		return;
+	}
+	for(auto arena = first; arena != nullptr; arena = arena->next) {
+		if(arena->contains(ptr)) {
+			arena->release(ptr);
+			return;
+		}
+	}
+	::operator delete(ptr);
+}
+
+} // namespace Graphics
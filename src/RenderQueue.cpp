@@ -44,16 +44,33 @@ void RenderQueue::run()
 		self->run();
 	};
 
+	if(done) {
+		return;
+	}
+
+	RenderArena::Scope scope(arena);
+
+	OneShotFastUs* deadline{nullptr};
+	if(timeSlice == 0) {
+		sliceTimer.start();
+	} else {
+		sliceTimer.reset(timeSlice);
+		deadline = &sliceTimer;
+	}
+
 	Surface* surface{nullptr};
+	bool rendered{false};
 	while(!done) {
 		if(surface == nullptr) {
 			surface = surfaces.pop();
 			if(surface == nullptr) {
 				break;
 			}
+			surface->setRenderDeadline(deadline);
 		}
 
 		done = execute(*surface);
+		rendered = true;
 		if(done && !queue.isEmpty()) {
 			// Surface not full, keep rendering
 			continue;
@@ -70,6 +87,11 @@ void RenderQueue::run()
 
 		active.add(surface);
 		surface = nullptr;
+
+		if(deadline != nullptr && deadline->expired()) {
+			// Give other tasks a chance, rendering resumes when the surface has been presented
+			break;
+		}
 	}
 
 	// Release unused surface
@@ -77,6 +99,10 @@ void RenderQueue::run()
 		surface->reset();
 		surfaces.add(surface);
 	}
+
+	if(rendered) {
+		sliceStats.update(sliceTimer.elapsedTime());
+	}
 }
 
 void RenderQueue::renderDone(const Object* object)
@@ -88,7 +114,7 @@ void RenderQueue::renderDone(const Object* object)
 	}
 	auto callback = [](void* param) {
 		auto item = static_cast<Item*>(param);
-		item->callback(const_cast<Object*>(&item->object));
+		item->callback(&item->object);
 		delete item;
 	};
 	if(item->delayMs == 0) {
@@ -101,6 +127,27 @@ void RenderQueue::renderDone(const Object* object)
 	}
 }
 
+bool RenderQueue::startRender(Surface& surface, const Object& object, std::unique_ptr<Renderer>& renderer)
+{
+	assert(&object == &item->object);
+	if(object.kind() != Object::Kind::Scene) {
+		return MultiRenderer::startRender(surface, object, renderer);
+	}
+
+	auto& scene = static_cast<SceneObject&>(item->object);
+	if(tileSize.w == 0 || tileSize.h == 0) {
+		if(!MultiRenderer::startRender(surface, object, renderer)) {
+			return false;
+		}
+	} else {
+		renderer = std::make_unique<TiledSceneRenderer>(location, scene, tileSize);
+	}
+
+	// Renderer has its own copy of the damage, so anything invalidated from here on is drawn next time
+	scene.damage.clear();
+	return true;
+}
+
 const Object* RenderQueue::getNextObject()
 {
 	if(queue.isEmpty()) {
@@ -109,6 +156,8 @@ const Object* RenderQueue::getNextObject()
 
 	item.reset(queue.pop());
 	location = item->location;
+	// Start of a new frame
+	arena.reset();
 	return &item->object;
 }
 
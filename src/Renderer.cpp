@@ -21,6 +21,7 @@
 
 #include "include/Graphics/Renderer.h"
 #include "include/Graphics/Surface.h"
+#include "include/Graphics/DisplayList.h"
 #include <Platform/Timers.h>
 
 #ifdef ENABLE_GRAPHICS_DEBUG
@@ -35,6 +36,35 @@ constexpr float M_PI{3.14159265358979};
 
 namespace Graphics
 {
+namespace
+{
+uint32_t isqrt(uint64_t value)
+{
+	uint64_t res{0};
+	uint64_t bit = 1ULL << 62;
+	while(bit > value) {
+		bit >>= 2;
+	}
+	while(bit != 0) {
+		if(value >= res + bit) {
+			value -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return res;
+}
+
+// Number of edges used to draw a round line cap
+constexpr unsigned roundCapSteps{8};
+
+// sin(n * PI / roundCapSteps) for the first quadrant, as 2.14 fixed-point
+constexpr int16_t sineTable[]{0, 6270, 11585, 15137, 16384};
+
+} // namespace
+
 /* PointList */
 
 bool PointList::render(Surface& surface)
@@ -64,6 +94,32 @@ bool PointList::render(Surface& surface)
 
 /* RectList */
 
+void RectList::add(const Rect& rect)
+{
+	auto r = intersect(rect, bounds.size());
+	if(!r) {
+		return;
+	}
+
+	for(unsigned i = index; i < count; ++i) {
+		auto& item = items[i];
+		if(item.x != r.x || item.w != r.w) {
+			continue;
+		}
+		if(item.y + item.h == r.y) {
+			item.h += r.h;
+			return;
+		}
+		if(r.y + r.h == item.y) {
+			item.y = r.y;
+			item.h += r.h;
+			return;
+		}
+	}
+
+	ItemList::add(r);
+}
+
 bool RectList::render(Surface& surface)
 {
 	object.brush.setPixelFormat(surface.getPixelFormat());
@@ -89,10 +145,105 @@ bool RectList::render(Surface& surface)
 	return true;
 }
 
+/* CoverageList */
+
+void CoverageList::add(Point pt, uint8_t alpha)
+{
+	if(alpha == 0 || !Rect(bounds.size()).contains(pt)) {
+		return;
+	}
+
+	// Extend an open segment if possible
+	for(unsigned i = count; i > 0 && i + 2 > count; --i) {
+		auto& seg = segments[i - 1];
+		if(seg.r.y != pt.y || seg.r.w == maxPixels) {
+			continue;
+		}
+		if(pt.x == seg.r.x + seg.r.w) {
+			seg.alpha[seg.r.w++] = alpha;
+			return;
+		}
+		if(pt.x + 1 == seg.r.x) {
+			memmove(&seg.alpha[1], &seg.alpha[0], seg.r.w);
+			seg.alpha[0] = alpha;
+			--seg.r.x;
+			++seg.r.w;
+			return;
+		}
+	}
+
+	assert(count < maxSegments);
+	auto& seg = segments[count++];
+	seg.r = Rect(pt, 1, 1);
+	seg.alpha[0] = alpha;
+	seg.blended = false;
+}
+
+void CoverageList::blend(Segment& segment)
+{
+	auto format = segment.format;
+	auto bytesPerPixel = getBytesPerPixel(format);
+	auto ptr = segment.data.get();
+	uint16_t src565 = __builtin_bswap16(color.value);
+	for(unsigned i = 0; i < segment.r.w; ++i, ptr += bytesPerPixel) {
+		uint8_t alpha = segment.alpha[i] * color.alpha / 255;
+		if(format == PixelFormat::RGB565) {
+			BlendAlpha::blendRGB565(src565, ptr, 2, alpha);
+		} else {
+			PackedColor c{color};
+			c.alpha = alpha;
+			BlendAlpha::blend(format, c, ptr, bytesPerPixel);
+		}
+	}
+}
+
+bool CoverageList::render(Surface& surface)
+{
+	if(count == 0) {
+		return true;
+	}
+
+	auto format = surface.getPixelFormat();
+	color = brush.getPackedColor(format);
+
+	// Queue all reads first so a single surface can handle them
+	for(; readIndex < count; ++readIndex) {
+		auto& seg = segments[readIndex];
+		seg.format = format;
+		if(!surface.setAddrWindow(seg.r + bounds.topLeft())) {
+			return false;
+		}
+		if(surface.readDataBuffer(seg) < 0) {
+			return false;
+		}
+	}
+
+	for(; writeIndex < count; ++writeIndex) {
+		auto& seg = segments[writeIndex];
+		if(!seg.status.readComplete) {
+			return false;
+		}
+		if(!seg.blended) {
+			blend(seg);
+			seg.blended = true;
+		}
+		if(!surface.setAddrWindow(seg.r + bounds.topLeft())) {
+			return false;
+		}
+		if(!surface.writeDataBuffer(seg.data, 0, seg.r.w * getBytesPerPixel(format))) {
+			return false;
+		}
+	}
+
+	count = readIndex = writeIndex = 0;
+	return true;
+}
+
 /* MultiRenderer */
 
 bool MultiRenderer::execute(Surface& surface)
 {
+	bool progress{false};
 	while(true) {
 		if(renderer) {
 			if(!surface.execute(renderer)) {
@@ -100,9 +251,14 @@ bool MultiRenderer::execute(Surface& surface)
 			}
 			renderDone(object);
 			object = nullptr;
+			progress = true;
 		}
 
 		if(object == nullptr) {
+			// Objects are a safe point to yield, provided at least one has completed
+			if(progress && surface.yieldRequired()) {
+				return false;
+			}
 			object = getNextObject();
 			if(object == nullptr) {
 				// Render complete
@@ -112,13 +268,503 @@ bool MultiRenderer::execute(Surface& surface)
 
 		debug_g("[RENDER] %s -> %s", object->toString().c_str(), location.toString().c_str());
 
-		if(!surface.render(*object, location.dest, renderer)) {
+		if(!startRender(surface, *object, renderer)) {
 			// Render couldn't be started, try again with another surface
 			return false;
 		}
 		if(!renderer) {
 			renderDone(object);
 			object = nullptr;
+			progress = true;
+		}
+	}
+}
+
+/* SceneRenderer */
+
+namespace
+{
+/*
+ * Opaque areas used for occlusion culling.
+ *
+ * Unlike DamageList these must never over-estimate, so rectangles are not merged.
+ * When full, the smallest area is discarded.
+ */
+class OccluderList
+{
+public:
+	void add(const Rect& rect)
+	{
+		if(!rect || contains(rect)) {
+			return;
+		}
+		unsigned i = 0;
+		while(i < count) {
+			if(rect.contains(rects[i])) {
+				rects[i] = rects[--count];
+			} else {
+				++i;
+			}
+		}
+		if(count < maxRects) {
+			rects[count++] = rect;
+			return;
+		}
+		unsigned smallest{0};
+		for(i = 1; i < count; ++i) {
+			if(rects[i].area() < rects[smallest].area()) {
+				smallest = i;
+			}
+		}
+		if(rect.area() > rects[smallest].area()) {
+			rects[smallest] = rect;
+		}
+	}
+
+	bool contains(const Rect& rect) const
+	{
+		for(unsigned i = 0; i < count; ++i) {
+			if(rects[i].contains(rect)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*
+	 * Remove hidden edges from a rectangle.
+	 * Only occluders spanning the full width or height are considered so the result remains a rectangle.
+	 */
+	Rect trim(Rect r) const
+	{
+		bool changed;
+		do {
+			changed = false;
+			for(unsigned i = 0; i < count; ++i) {
+				auto& o = rects[i];
+				if(!o.intersects(r)) {
+					continue;
+				}
+				if(o.contains(r)) {
+					return Rect{};
+				}
+				if(o.left() <= r.left() && o.right() >= r.right()) {
+					if(o.top() <= r.top()) {
+						auto h = 1 + o.bottom() - r.top();
+						r.y += h;
+						r.h -= h;
+						changed = true;
+					} else if(o.bottom() >= r.bottom()) {
+						r.h = o.top() - r.top();
+						changed = true;
+					}
+				} else if(o.top() <= r.top() && o.bottom() >= r.bottom()) {
+					if(o.left() <= r.left()) {
+						auto w = 1 + o.right() - r.left();
+						r.x += w;
+						r.w -= w;
+						changed = true;
+					} else if(o.right() >= r.right()) {
+						r.w = o.left() - r.left();
+						changed = true;
+					}
+				}
+			}
+		} while(changed);
+		return r;
+	}
+
+	void clear()
+	{
+		count = 0;
+	}
+
+private:
+	static constexpr uint8_t maxRects{8};
+	Rect rects[maxRects];
+	uint8_t count{0};
+};
+
+/*
+ * Get area of an object which is guaranteed to be completely overwritten
+ */
+Rect getOpaqueArea(const Object& object)
+{
+	switch(object.kind()) {
+	case Object::Kind::FilledRect: {
+		auto& fill = static_cast<const FilledRectObject&>(object);
+		if(fill.blender != nullptr || !fill.brush || fill.brush.isTransparent()) {
+			break;
+		}
+		// Rounded rectangles are drawn with a full-width centre section
+		Rect r = fill.rect;
+		if(fill.radius != 0) {
+			if(r.h <= 2 * fill.radius) {
+				break;
+			}
+			r.y += fill.radius;
+			r.h -= 2 * fill.radius;
+		}
+		return r;
+	}
+
+	case Object::Kind::Image: {
+		// Images with per-pixel alpha are blended with whatever is underneath
+		auto& image = static_cast<const ImageObject&>(object);
+		if(image.getAlphaMode() != ImageObject::AlphaMode::none) {
+			break;
+		}
+		return Rect(image.getSize());
+	}
+
+	case Object::Kind::Reference: {
+		auto& ref = static_cast<const ReferenceObject&>(object);
+		if(ref.blend != nullptr || ref.object.kind() != Object::Kind::Image) {
+			break;
+		}
+		auto& image = static_cast<const ImageObject&>(ref.object);
+		if(image.getAlphaMode() != ImageObject::AlphaMode::none) {
+			break;
+		}
+		auto size = image.getSize();
+		auto& ofs = ref.sourceOffset;
+		if(ofs.x < 0 || ofs.y < 0 || ofs.x >= size.w || ofs.y >= size.h) {
+			break;
+		}
+		Rect r(ref.pos.topLeft(), size.w - ofs.x, size.h - ofs.y);
+		return intersect(r, ref.pos);
+	}
+
+	default:;
+	}
+
+	return Rect{};
+}
+
+/*
+ * Objects which read display memory depend on everything drawn before them
+ */
+bool readsDisplay(const Object& object)
+{
+	switch(object.kind()) {
+	case Object::Kind::Copy:
+	case Object::Kind::Scroll:
+	case Object::Kind::Surface:
+	case Object::Kind::Recording:
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+SceneRenderer::SceneRenderer(const Location& location, const SceneObject& scene, const DamageList& damage)
+	: MultiRenderer(location), scene(scene), damage(damage)
+{
+}
+
+/*
+ * Scene content may not be available during construction (e.g. ControlRenderer builds it afterwards),
+ * so this is done when rendering starts.
+ */
+void SceneRenderer::init()
+{
+	auto objectCount = scene.objects.count();
+	if(objectCount == 0) {
+		return;
+	}
+
+	/*
+	 * Occlusion pass
+	 *
+	 * Walk objects from last to first, tracking opaque areas drawn by later objects.
+	 * Anything completely covered is skipped, and filled rectangles have hidden edges trimmed.
+	 * Occluders are discarded at objects which read display memory, such as Copy.
+	 */
+	std::unique_ptr<const Object*[]> objects(new const Object*[objectCount]);
+	unsigned i{0};
+	for(auto& object : scene.objects) {
+		objects[i++] = &object;
+	}
+	bounds.reset(new Rect[objectCount]);
+	OccluderList occluders;
+	unsigned SMING_UNUSED hiddenCount{0};
+	while(i-- != 0) {
+		auto& object = *objects[i];
+		auto r = object.getBounds();
+		if(!r) {
+			// Extent unknown so cannot be culled
+			bounds[i] = Rect(scene.getSize());
+			if(readsDisplay(object)) {
+				occluders.clear();
+			}
+			continue;
+		}
+		r = isClippable(object) ? occluders.trim(r) : occluders.contains(r) ? Rect{} : r;
+		bounds[i] = r;
+		if(!r) {
+			++hiddenCount;
+		} else if(readsDisplay(object)) {
+			occluders.clear();
+		} else {
+			occluders.add(getOpaqueArea(object));
+		}
+	}
+	debug_g("[SCENE] %u of %u objects hidden", hiddenCount, objectCount);
+
+	if(!damage) {
+		return;
+	}
+
+	// Objects which can't be clipped are drawn in full, so extend damage to cover them
+	bool changed;
+	do {
+		changed = false;
+		for(i = 0; i < objectCount; ++i) {
+			auto& r = bounds[i];
+			if(!r || isClippable(*objects[i])) {
+				continue;
+			}
+			if(damage.intersects(r) && !damage.contains(r)) {
+				damage.add(r);
+				changed = true;
+			}
+		}
+	} while(changed);
+
+	if(damage.contains(Rect(scene.getSize()))) {
+		damage.clear();
+	}
+
+	debug_g("[SCENE] damage %s", damage.toString().c_str());
+}
+
+const Object* SceneRenderer::getNextObject()
+{
+	if(!initialised) {
+		init();
+		initialised = true;
+	}
+
+	for(;;) {
+		// Emit a clipped copy of the current fill for each damaged area it touches
+		if(clipSource != nullptr) {
+			auto& r = bounds[objectIndex];
+			unsigned clipCount = damage ? damage.size() : 1;
+			while(clipIndex < clipCount) {
+				auto rc = damage ? intersect(r, damage[clipIndex]) : r;
+				++clipIndex;
+				if(rc) {
+					clipObject.blender = clipSource->blender;
+					clipObject.brush = clipSource->brush;
+					clipObject.rect = rc;
+					return &clipObject;
+				}
+			}
+			clipSource = nullptr;
+		}
+
+		if(nextObject == nullptr) {
+			nextObject = scene.objects.head();
+			objectIndex = 0;
+		} else {
+			nextObject = nextObject->getNext();
+			++objectIndex;
+		}
+		if(nextObject == nullptr) {
+			return nullptr;
+		}
+
+		auto& r = bounds[objectIndex];
+		if(!r) {
+			// Hidden
+			continue;
+		}
+
+		if(isClippable(*nextObject)) {
+			auto& fill = static_cast<const FilledRectObject&>(*nextObject);
+			if(!damage && r == fill.rect) {
+				return nextObject;
+			}
+			clipSource = &fill;
+			clipIndex = 0;
+			continue;
+		}
+
+		if(!damage || damage.intersects(r)) {
+			return nextObject;
+		}
+	}
+}
+
+/* TiledSceneRenderer */
+
+bool TiledSceneRenderer::init(Surface& surface)
+{
+	auto objectCount = scene.objects.count();
+	bounds.reset(new Rect[objectCount]);
+	unsigned i{0};
+	for(auto& obj : scene.objects) {
+		switch(obj.kind()) {
+		case Object::Kind::Copy:
+		case Object::Kind::Scroll:
+		case Object::Kind::Surface:
+		case Object::Kind::Recording:
+			// These work directly with display memory
+			return false;
+		default:;
+		}
+		auto r = obj.getBounds();
+		bounds[i++] = r ? r : Rect(scene.getSize());
+	}
+
+	pixelFormat = surface.getPixelFormat();
+	size_t tileBytes = tileSize.w * tileSize.h * getBytesPerPixel(pixelFormat);
+	// Display list data length is limited to 15 bits
+	if(tileBytes == 0 || tileBytes > 0x7fff) {
+		debug_w("[TILE] Bad tile size %s", tileSize.toString().c_str());
+		return false;
+	}
+	image.reset(new (RenderArena::transient) MemoryImageObject(pixelFormat, tileSize));
+	if(!image->isValid()) {
+		return false;
+	}
+	tileSurface.reset(image->createSurface());
+
+	area = intersect(scene.getSize(), location.dest.size());
+	tile = Rect{};
+	return true;
+}
+
+bool TiledSceneRenderer::nextTile()
+{
+	if(!area) {
+		return false;
+	}
+
+	do {
+		if(!tile) {
+			tile = Rect(area.topLeft(), tileSize);
+		} else {
+			tile.x += tileSize.w;
+			if(tile.x > area.right()) {
+				tile.x = area.x;
+				tile.y += tileSize.h;
+				if(tile.y > area.bottom()) {
+					return false;
+				}
+			}
+			tile = Rect(tile.topLeft(), tileSize);
+		}
+		// Tiles on right and bottom edges may be smaller
+		tile.clip(area);
+	} while(damage && !damage.intersects(tile));
+
+	// Start with the last opaque fill covering the tile, if there is one
+	object = scene.objects.head();
+	objectIndex = 0;
+	const Object* first{nullptr};
+	unsigned firstIndex{0};
+	unsigned i{0};
+	for(auto& obj : scene.objects) {
+		if(obj.kind() == Object::Kind::FilledRect && bounds[i].contains(tile)) {
+			auto& fill = static_cast<const FilledRectObject&>(obj);
+			if(fill.radius == 0 && fill.blender == nullptr && fill.brush.isSolid() && !fill.brush.isTransparent()) {
+				first = &obj;
+				firstIndex = i;
+			}
+		}
+		++i;
+	}
+
+	if(first != nullptr) {
+		object = first;
+		objectIndex = firstIndex;
+	} else {
+		// Tile content must be read back from display
+		renderer = std::make_unique<SurfaceRenderer>(Location{tile.size()}, *tileSurface, tile.size(),
+													 location.dest.topLeft() + tile.topLeft());
+	}
+
+	return true;
+}
+
+bool TiledSceneRenderer::execute(Surface& surface)
+{
+	for(;;) {
+		if(!surface.execute(renderer)) {
+			return false;
+		}
+
+		switch(state) {
+		case State::init:
+			if(init(surface)) {
+				state = State::nextTile;
+				break;
+			}
+			debug_w("[TILE] Using regular scene renderer");
+			image.reset();
+			tileSurface.reset();
+			renderer = std::make_unique<SceneRenderer>(location, scene, damage);
+			state = State::done;
+			break;
+
+		case State::nextTile:
+			state = nextTile() ? State::draw : State::done;
+			break;
+
+		case State::draw: {
+			// Objects are drawn relative to tile origin
+			Rect dest = Rect(location.dest.size()) - tile.topLeft();
+			for(; object != nullptr; object = object->getNext(), ++objectIndex) {
+				if(!tileRenderer) {
+					if(!bounds[objectIndex].intersects(tile)) {
+						continue;
+					}
+					if(!tileSurface->render(*object, dest, tileRenderer)) {
+						return false;
+					}
+				}
+				if(!tileSurface->execute(tileRenderer)) {
+					// Renderer is waiting on a callback
+					return false;
+				}
+			}
+			state = State::write;
+			break;
+		}
+
+		case State::write: {
+			auto bpp = getBytesPerPixel(pixelFormat);
+			size_t length = tile.w * tile.h * bpp;
+			if(writeBuffer.usage_count() > 1) {
+				// Previous tile still in transit
+				writeBuffer = SharedBuffer{};
+			}
+			if(!writeBuffer) {
+				writeBuffer.init(tileSize.w * tileSize.h * bpp);
+			}
+			Location loc;
+			auto bufptr = writeBuffer.get();
+			for(loc.pos.y = 0; loc.pos.y < tile.h; ++loc.pos.y) {
+				bufptr += image->readPixels(loc, pixelFormat, bufptr, tile.w);
+			}
+			if(!surface.setAddrWindow(tile + location.dest.topLeft())) {
+				return false;
+			}
+			if(!surface.writeDataBuffer(writeBuffer, 0, length)) {
+				return false;
+			}
+			state = State::nextTile;
+			if(surface.yieldRequired()) {
+				return false;
+			}
+			break;
+		}
+
+		case State::done:
+			return true;
 		}
 	}
 }
@@ -430,12 +1076,54 @@ void LineRenderer::drawVertical()
 	r.y += r.h;
 }
 
+/* AntialiasedLineRenderer */
+
+AntialiasedLineRenderer::AntialiasedLineRenderer(const Location& location, const Pen& pen, Point pt1, Point pt2)
+	: Renderer(location), pixels(location.dest, pen)
+{
+	steep = abs(pt2.y - pt1.y) > abs(pt2.x - pt1.x);
+	if(steep) {
+		std::swap(pt1.x, pt1.y);
+		std::swap(pt2.x, pt2.y);
+	}
+	if(pt1.x > pt2.x) {
+		std::swap(pt1, pt2);
+	}
+	x = pt1.x;
+	xend = pt2.x;
+	y = pt1.y * 0x10000;
+	dy = (pt1.x == pt2.x) ? 0 : int64_t(pt2.y - pt1.y) * 0x10000 / (pt2.x - pt1.x);
+}
+
+bool AntialiasedLineRenderer::execute(Surface& surface)
+{
+	for(;;) {
+		if(x > xend || pixels.available() < 2) {
+			if(!pixels.render(surface)) {
+				return false;
+			}
+			if(x > xend) {
+				return true;
+			}
+		}
+
+		// Coverage is split between the two pixels straddling the ideal line
+		int16_t yi = y >> 16;
+		uint8_t frac = y >> 8;
+		plot(x, yi, 255 - frac);
+		plot(x, yi + 1, frac);
+		y += dy;
+		++x;
+	}
+}
+
 /* PolylineRenderer */
 
 bool PolylineRenderer::execute(Surface& surface)
 {
 	if(!line.pen) {
 		line.pen = Pen(object.pen, surface.getPixelFormat());
+		line.cap = object.cap;
 	}
 
 	// debug_g("POLY(%s, %u)", object.rect.toString().c_str(), object->color);
@@ -459,6 +1147,249 @@ bool PolylineRenderer::execute(Surface& surface)
 	return true;
 }
 
+/* FilledPolygonRenderer */
+
+FilledPolygonRenderer::FilledPolygonRenderer(const Location& location, const FilledPolygonObject& object)
+	: FilledPolygonRenderer(location, object.brush)
+{
+	auto numPoints = object.numPoints;
+	std::unique_ptr<IntPoint[]> vertices(new IntPoint[numPoints]);
+	for(unsigned i = 0; i < numPoints; ++i) {
+		vertices[i] = IntPoint(object[i].x * 0x100, object[i].y * 0x100);
+	}
+	init(vertices.get(), numPoints);
+}
+
+void FilledPolygonRenderer::init(const IntPoint* vertices, unsigned count)
+{
+	if(count == 0) {
+		return;
+	}
+
+	int32_t bottom = vertices[0].y;
+	for(unsigned i = 1; i < count; ++i) {
+		bottom = std::max(bottom, vertices[i].y);
+	}
+
+	/*
+	 * Edges exclude their last row as it's the first row of the edge which follows.
+	 * Nothing follows at a local minimum (the bottom of the polygon or of a downward spike)
+	 * so the row must be included. Horizontal edges are skipped over.
+	 */
+	auto isLocalMinimum = [&](unsigned index, int step) -> bool {
+		auto y = vertices[index].y;
+		for(unsigned n = 1; n < count; ++n) {
+			index = (index + count + step) % count;
+			if(vertices[index].y != y) {
+				return vertices[index].y < y;
+			}
+		}
+		return true;
+	};
+
+	edges.reset(new Edge[count]);
+	for(unsigned i = 0; i < count; ++i) {
+		auto pt1 = vertices[i];
+		auto pt2 = vertices[(i + 1) % count];
+		if(pt1.y == pt2.y) {
+			// Horizontal edges are covered by spans of adjoining edges
+			continue;
+		}
+		// Lower vertex, and direction to continue around the outline from it
+		unsigned lower = (i + 1) % count;
+		int step = 1;
+		if(pt1.y > pt2.y) {
+			std::swap(pt1, pt2);
+			lower = i;
+			step = -1;
+		}
+		Edge edge;
+		edge.y1 = (pt1.y + 0xff) >> 8;
+		edge.y2 = isLocalMinimum(lower, step) ? (pt2.y >> 8) + 1 : (pt2.y + 0xff) >> 8;
+		if(edge.y1 >= edge.y2) {
+			// Edge lies between scanlines
+			continue;
+		}
+		edge.dx = int64_t(pt2.x - pt1.x) * 0x10000 / (pt2.y - pt1.y);
+		edge.x = pt1.x * 0x100 + 0x8000 + int64_t(edge.dx) * (edge.y1 * 0x100 - pt1.y) / 0x100;
+
+		// Keep table sorted by starting row
+		unsigned j = edgeCount++;
+		while(j > 0 && edges[j - 1].y1 > edge.y1) {
+			edges[j] = edges[j - 1];
+			--j;
+		}
+		edges[j] = edge;
+	}
+
+	if(edgeCount == 0) {
+		// Polygon is a horizontal line, or too thin to cross any scanline
+		int32_t x1 = vertices[0].x;
+		int32_t x2 = x1;
+		for(unsigned i = 1; i < count; ++i) {
+			x1 = std::min(x1, vertices[i].x);
+			x2 = std::max(x2, vertices[i].x);
+		}
+		int16_t row = bottom >> 8;
+		rectangles.add(Rect(Point((x1 + 0x80) >> 8, row), Point((x2 + 0x80) >> 8, row)));
+		return;
+	}
+
+	active.reset(new Edge*[edgeCount]);
+	spans.reset(new int16_t[edgeCount]);
+	y = std::max(edges[0].y1, int16_t(0));
+	ymax = std::min((bottom >> 8) + 1, int(location.dest.h));
+}
+
+void FilledPolygonRenderer::nextRow()
+{
+	// Drop finished edges
+	unsigned n{0};
+	for(unsigned i = 0; i < activeCount; ++i) {
+		if(y < active[i]->y2) {
+			active[n++] = active[i];
+		}
+	}
+	activeCount = n;
+
+	// Add edges starting on this row, or above it if clipped
+	while(nextEdge < edgeCount && edges[nextEdge].y1 <= y) {
+		auto& edge = edges[nextEdge++];
+		if(y >= edge.y2) {
+			continue;
+		}
+		edge.x += edge.dx * (y - edge.y1);
+		active[activeCount++] = &edge;
+	}
+
+	// Order doesn't change much between rows so insertion sort is a good fit
+	for(unsigned i = 1; i < activeCount; ++i) {
+		auto edge = active[i];
+		unsigned j = i;
+		while(j > 0 && active[j - 1]->x > edge->x) {
+			active[j] = active[j - 1];
+			--j;
+		}
+		active[j] = edge;
+	}
+
+	// Even-odd rule, merging spans which touch
+	spanCount = spanIndex = 0;
+	for(unsigned i = 0; i + 1 < activeCount; i += 2) {
+		int16_t x1 = active[i]->x >> 16;
+		int16_t x2 = active[i + 1]->x >> 16;
+		if(spanCount != 0 && x1 <= spans[spanCount - 1] + 1) {
+			spans[spanCount - 1] = std::max(spans[spanCount - 1], x2);
+		} else {
+			spans[spanCount++] = x1;
+			spans[spanCount++] = x2;
+		}
+	}
+
+	for(unsigned i = 0; i < activeCount; ++i) {
+		active[i]->x += active[i]->dx;
+	}
+
+	++y;
+}
+
+bool FilledPolygonRenderer::execute(Surface& surface)
+{
+	for(;;) {
+		// Hold spans back until the list is full so those on consecutive rows can be merged
+		bool done = spanIndex >= spanCount && (y >= ymax || (activeCount == 0 && nextEdge >= edgeCount));
+		if((done || rectangles.available() == 0) && !rectangles.render(surface)) {
+			return false;
+		}
+
+		if(done) {
+			return true;
+		}
+
+		if(spanIndex < spanCount) {
+			// Spans belong to the row before the current one
+			for(; spanIndex < spanCount && rectangles.available() != 0; spanIndex += 2) {
+				auto x1 = spans[spanIndex];
+				auto x2 = spans[spanIndex + 1];
+				rectangles.add(Rect(x1, y - 1, 1 + x2 - x1, 1));
+			}
+			continue;
+		}
+
+		nextRow();
+	}
+}
+
+/* ThickLineRenderer */
+
+ThickLineRenderer::ThickLineRenderer(const Location& location, const Pen& pen, Point pt1, Point pt2, LineCap cap)
+	: FilledPolygonRenderer(location, pen)
+{
+	IntPoint vertices[2 * (roundCapSteps + 1)];
+
+	if(cap == LineCap::None) {
+		// Pen width extends lines to the right and downwards
+		int16_t t = pen.width - 1;
+		Point ofs = (abs(pt2.x - pt1.x) >= abs(pt2.y - pt1.y)) ? Point(0, t) : Point(t, 0);
+		Point points[]{pt1, pt2, pt2 + ofs, pt1 + ofs};
+		for(unsigned i = 0; i < 4; ++i) {
+			vertices[i] = IntPoint(points[i].x * 0x100, points[i].y * 0x100);
+		}
+		init(vertices, 4);
+		return;
+	}
+
+	// Unit vector perpendicular to the line, 2.14 fixed-point. The unit vector along the line is (uy, -ux).
+	int32_t dx = pt2.x - pt1.x;
+	int32_t dy = pt2.y - pt1.y;
+	int32_t ux{0};
+	int32_t uy{0x4000};
+	if(dx != 0 || dy != 0) {
+		auto len = isqrt((int64_t(dx) * dx + int64_t(dy) * dy) << 28);
+		ux = -int64_t(dy) * 0x10000000 / len;
+		uy = int64_t(dx) * 0x10000000 / len;
+	}
+
+	/*
+	 * Get vertex at half the pen width from an end point in the given direction.
+	 *
+	 * Scanlines include the pixels at each end, so move vertices in by half a pixel horizontally to compensate.
+	 * A further nudge up and to the left ensures edges lying exactly on pixel centres include only one of them.
+	 */
+	int32_t radius = pen.width * 0x80;
+	auto vertex = [radius](Point pt, int32_t dirx, int32_t diry) -> IntPoint {
+		IntPoint v(pt.x * 0x100 + ((int64_t(dirx) * radius) >> 14) - 1,
+				   pt.y * 0x100 + ((int64_t(diry) * radius) >> 14) - 1);
+		if(dirx > 0) {
+			v.x -= 0x80;
+		} else if(dirx < 0) {
+			v.x += 0x80;
+		}
+		return v;
+	};
+
+	if(cap == LineCap::Square) {
+		vertices[0] = vertex(pt2, ux + uy, uy - ux);
+		vertices[1] = vertex(pt2, uy - ux, -ux - uy);
+		vertices[2] = vertex(pt1, -ux - uy, ux - uy);
+		vertices[3] = vertex(pt1, ux - uy, ux + uy);
+		init(vertices, 4);
+		return;
+	}
+
+	// Semi-circle around each end point, from one side of the line to the other
+	for(unsigned i = 0; i <= roundCapSteps; ++i) {
+		constexpr unsigned q = roundCapSteps / 2;
+		int32_t c = (i <= q) ? sineTable[q - i] : -sineTable[i - q];
+		int32_t s = sineTable[(i <= q) ? i : roundCapSteps - i];
+		int32_t dirx = (ux * c + uy * s) >> 14;
+		int32_t diry = (uy * c - ux * s) >> 14;
+		vertices[i] = vertex(pt2, dirx, diry);
+		vertices[roundCapSteps + 1 + i] = vertex(pt1, -dirx, -diry);
+	}
+	init(vertices, 2 * (roundCapSteps + 1));
+}
+
 /* FilledRectRenderer */
 
 bool FilledRectRenderer::execute(Surface& surface)
@@ -588,48 +1519,6 @@ bool RoundedRectRenderer::execute(Surface& surface)
 	return true;
 }
 
-/* FilledRoundedRectRenderer */
-
-bool FilledRoundedRectRenderer::execute(Surface& surface)
-{
-	// debug_g("RECT(%s, %u, %u)", object.rect.toString().c_str(), object->color, object->radius);
-
-	object.brush.setPixelFormat(surface.getPixelFormat());
-
-	for(;;) {
-		if(!surface.execute(renderer)) {
-			return false;
-		}
-
-		switch(state) {
-		case 0:
-		case 1: {
-			auto& rect = this->object.rect;
-			auto r = object.radius;
-			renderer = std::make_unique<FilledCircleRenderer>(location, object.brush, corners[state], r,
-															  rect.w - 2 * (r + 1), 0x01 << state);
-			break;
-		}
-		case 2: {
-			// Central rectangle
-			object.rect.y += object.radius;
-			object.rect.h -= object.radius * 2;
-			object.radius = 0;
-			if(!surface.render(object, location.dest, renderer)) {
-				return false;
-			}
-			break;
-		}
-		default:
-			return true;
-		}
-
-		++state;
-	}
-
-	return true;
-}
-
 /*
  * CircleRenderer
  *
@@ -688,7 +1577,8 @@ bool CircleRenderer::execute(Surface& surface)
 bool FilledCircleRenderer::execute(Surface& surface)
 {
 	for(;;) {
-		if(!rectangles.render(surface)) {
+		// Each step adds up to 4 lines
+		if((y >= x || rectangles.available() < 4) && !rectangles.render(surface)) {
 			return false;
 		}
 
@@ -709,18 +1599,18 @@ bool FilledCircleRenderer::execute(Surface& surface)
 		// for the SSD1306 library which has an INVERT drawing mode.
 		if(y <= x) {
 			if(quadrants & 0x01) {
-				addLine(x0 - x, x0 + x + delta, y0 - y);
+				addLine(x0 - x, x0 + x + delta.w, y0 - y);
 			}
 			if(quadrants & 0x02) {
-				addLine(x0 - x, x0 + x + delta, y0 + y);
+				addLine(x0 - x, x0 + x + delta.w, y0 + y + delta.h);
 			}
 		}
 		if(x != px) {
 			if(quadrants & 0x01) {
-				addLine(x0 - py, x0 + py + delta, y0 - px);
+				addLine(x0 - py, x0 + py + delta.w, y0 - px);
 			}
 			if(quadrants & 0x02) {
-				addLine(x0 - py, x0 + py + delta, y0 + px);
+				addLine(x0 - py, x0 + py + delta.w, y0 + px + delta.h);
 			}
 			px = x;
 		}
@@ -728,6 +1618,79 @@ bool FilledCircleRenderer::execute(Surface& surface)
 	}
 }
 
+/* AntialiasedEllipseRenderer */
+
+AntialiasedEllipseRenderer::AntialiasedEllipseRenderer(const Location& location, const Pen& pen, const Rect& rect)
+	: Renderer(location), pixels(location.dest, pen), a((rect.w - 1) / 2), b((rect.h - 1) / 2), dx((rect.w - 1) % 2),
+	  dy((rect.h - 1) % 2)
+{
+	centre = Point(rect.x + a, rect.y + b);
+	limit = a * a / isqrt(a * a + b * b);
+}
+
+void AntialiasedEllipseRenderer::step()
+{
+	uint32_t a2 = a * a;
+	uint32_t b2 = b * b;
+	bool right = pass & 0x02;
+	bool bottom = pass & 0x04;
+	auto xpos = [&](int16_t x) -> int16_t { return right ? centre.x + dx + x : centre.x - x; };
+	auto ypos = [&](int16_t y) -> int16_t { return bottom ? centre.y + dy + y : centre.y - y; };
+
+	// Don't draw pixels on an axis twice
+	if(i == 0 && ((pass & 0x01) ? (bottom && dy == 0) : (right && dx == 0))) {
+		return;
+	}
+
+	// Distance from centre to ideal curve, 8-bit fraction
+	if(pass & 0x01) {
+		// Steep region, step vertically
+		uint32_t v = isqrt((uint64_t(a2) * (b2 - i * i) << 16) / b2);
+		int16_t xi = v >> 8;
+		uint8_t frac = v;
+		int16_t y = ypos(i);
+		if(right) {
+			pixels.add(Point(xpos(xi), y), 255 - frac);
+			pixels.add(Point(xpos(xi + 1), y), frac);
+		} else {
+			pixels.add(Point(xpos(xi + 1), y), frac);
+			pixels.add(Point(xpos(xi), y), 255 - frac);
+		}
+	} else {
+		// Shallow region, step horizontally
+		uint32_t v = isqrt((uint64_t(b2) * (a2 - i * i) << 16) / a2);
+		int16_t yi = v >> 8;
+		uint8_t frac = v;
+		int16_t x = xpos(i);
+		pixels.add(Point(x, ypos(yi)), 255 - frac);
+		pixels.add(Point(x, ypos(yi + 1)), frac);
+	}
+}
+
+bool AntialiasedEllipseRenderer::execute(Surface& surface)
+{
+	for(;;) {
+		if(pass == 8 || pixels.available() < 2) {
+			if(!pixels.render(surface)) {
+				return false;
+			}
+			if(pass == 8) {
+				return true;
+			}
+		}
+
+		step();
+		if(i++ < limit) {
+			continue;
+		}
+
+		// Move to next region
+		++pass;
+		i = 0;
+		limit = (pass & 0x01) ? b * b / isqrt(a * a + b * b) : a * a / isqrt(a * a + b * b);
+	}
+}
+
 /* EllipseRenderer */
 
 bool EllipseRenderer::execute(Surface& surface)
@@ -917,7 +1880,8 @@ bool FilledEllipseRenderer::execute(Surface& surface)
 	}
 
 	for(;;) {
-		if(rectangles && !rectangles.render(surface)) {
+		// Allow for up to 4 rectangles per step, as used by FilledArcRenderer
+		if((state == State::done || rectangles.available() < 4) && !rectangles.render(surface)) {
 			return false;
 		}
 
@@ -942,7 +1906,8 @@ bool FilledEllipseRenderer::execute(Surface& surface)
 				r1 = Rect(r.x, r2.y, r.w, r1.y + r1.h - r2.y);
 				continue;
 			}
-			break;
+			state = State::done;
+			continue;
 		}
 
 		doStep(e.step());
@@ -1395,11 +2360,7 @@ bool ImageRenderer::execute(Surface& surface)
 		bytesPerPixel = getBytesPerPixel(pixelFormat);
 	}
 
-	/*
-	 * Normally we'd expect to be able to refill surface buffers faster than the data
-	 * is transferred over SPI to the display. However, if reading from a resource in flash
-	 * this may no longer be the case so use a timer to guard against hogging the CPU.
-	 */
+	// Fallback for surfaces with no render deadline set
 	OneShotFastMs timeout;
 	timeout.reset<50>();
 
@@ -1411,9 +2372,14 @@ bool ImageRenderer::execute(Surface& surface)
 		if(available < 8) {
 			if(buffer != nullptr) {
 				surface.commit(bufptr - buffer);
-			}
-			if(timeout.expired()) {
-				return false;
+				/*
+				 * Normally we'd expect to be able to refill surface buffers faster than the data
+				 * is transferred over SPI to the display. However, if reading from a resource in flash
+				 * this may no longer be the case so yield if the time slice has been used up.
+				 */
+				if(surface.hasRenderDeadline() ? surface.yieldRequired() : timeout.expired()) {
+					return false;
+				}
 			}
 			bufptr = buffer = surface.getBuffer(bytesPerPixel, available);
 			if(buffer == nullptr) {
@@ -1528,7 +2494,7 @@ void CopyRenderer::init()
 	}
 
 	// Assume that reading requires space for full 24-bit RGB (e.g. ILI9341)
-	auto bufSize = lineSize * Surface::READ_PIXEL_SIZE;
+	auto bufSize = lineSize * std::max(Surface::READ_PIXEL_SIZE, size_t(bytesPerPixel));
 	lineBuffers[0] = LineBuffer{pixelFormat, bufSize};
 	lineBuffers[1] = LineBuffer{pixelFormat, bufSize};
 }
@@ -1588,30 +2554,64 @@ void CopyRenderer::startRead(Surface& surface)
 
 void ImageCopyRenderer::readComplete(uint8_t* data, size_t length)
 {
-	if(blend == nullptr) {
+	if(blend == nullptr && image.getAlphaMode() == ImageObject::AlphaMode::none) {
 		return;
 	}
 	auto loc = location;
 	loc.source.x = loc.source.y = 0;
 	size_t bufSize = loc.dest.w * bytesPerPixel;
-	uint8_t buffer[bufSize];
 
 	if(vertical) {
 		while(length != 0) {
-			image.readPixels(loc, pixelFormat, buffer, loc.dest.w);
+			blendLine(loc, data);
 			++loc.pos.y;
-			blend->transform(pixelFormat, buffer, data, bufSize);
 			data += bufSize;
 			length -= bufSize;
 		}
 		++location.pos.x;
 	} else {
-		image.readPixels(loc, pixelFormat, buffer, loc.dest.w);
-		blend->transform(pixelFormat, buffer, data, bufSize);
+		blendLine(loc, data);
 		++location.pos.y;
 	}
 }
 
+void ImageCopyRenderer::blendLine(const Location& loc, uint8_t* data)
+{
+	// Work through the line in chunks to keep stack usage bounded
+	constexpr uint16_t chunkPixels{32};
+	uint8_t buffer[chunkPixels * 4];
+	uint8_t alpha[chunkPixels];
+	uint8_t composite[chunkPixels * 4];
+
+	auto alphaMode = image.getAlphaMode();
+	bool premultiplied = (alphaMode == ImageObject::AlphaMode::premultiplied);
+	Location l = loc;
+	uint16_t width = loc.dest.w;
+	while(width != 0) {
+		auto n = std::min(width, chunkPixels);
+		size_t len = n * bytesPerPixel;
+
+		if(alphaMode == ImageObject::AlphaMode::none) {
+			image.readPixels(l, pixelFormat, buffer, n);
+			blend->transform(pixelFormat, buffer, data, len);
+		} else {
+			image.readAlphaPixels(l, pixelFormat, buffer, alpha, n);
+			if(blend == nullptr) {
+				BlendAlpha::blend(pixelFormat, buffer, alpha, data, n, premultiplied);
+			} else {
+				// Composite image over display content, then apply blend to the result
+				memcpy(composite, data, len);
+				BlendAlpha::blend(pixelFormat, buffer, alpha, composite, n, premultiplied);
+				blend->transform(pixelFormat, composite, data, len);
+			}
+		}
+
+		l.pos.x += n;
+		data += len;
+		width -= n;
+	}
+}
+
 /* ScrollRenderer */
 
 void ScrollRenderer::init()
@@ -1894,6 +2894,144 @@ void ScrollRenderer::stepy(uint16_t& index, int16_t& y)
 	}
 }
 
+/* RecordingRenderer */
+
+bool RecordingRenderer::read(void* data, uint16_t length)
+{
+	auto dst = static_cast<uint8_t*>(data);
+	uint16_t n = std::min(length, uint16_t(buflen - bufpos));
+	memcpy(dst, &buffer[bufpos], n);
+	bufpos += n;
+	dst += n;
+	length -= n;
+	if(length == 0) {
+		return true;
+	}
+	if(length >= sizeof(buffer)) {
+		// Large blocks go straight from stream
+		return object.stream->readBytes(dst, length) == length;
+	}
+	buflen = object.stream->readBytes(buffer, sizeof(buffer));
+	bufpos = std::min(length, uint16_t(buflen));
+	memcpy(dst, buffer, bufpos);
+	return bufpos == length;
+}
+
+bool RecordingRenderer::readVar(uint16_t& value)
+{
+	uint8_t c;
+	if(!read(&c, 1)) {
+		return false;
+	}
+	value = c;
+	if(c & 0x80) {
+		if(!read(&c, 1)) {
+			return false;
+		}
+		value = ((value & 0x7f) << 8) | c;
+	}
+	return true;
+}
+
+bool RecordingRenderer::readEntry()
+{
+	using Code = DisplayList::Code;
+
+	DisplayList::Header hdr;
+	if(!read(&hdr.u8, 1)) {
+		return false;
+	}
+	uint16_t length = hdr.len;
+	if(length == DisplayList::Header::lenMax && !readVar(length)) {
+		return false;
+	}
+
+	uint16_t value;
+	switch(hdr.code) {
+	case Code::setColumn:
+		if(!readVar(value)) {
+			return false;
+		}
+		window.x = location.dest.x + value;
+		window.w = length + 1;
+		// Row may be unchanged and omitted
+		windowPending = true;
+		return true;
+	case Code::setRow:
+		if(!readVar(value)) {
+			return false;
+		}
+		window.y = location.dest.y + value;
+		window.h = length + 1;
+		windowPending = true;
+		return true;
+	case Code::writeStart:
+	case Code::writeData:
+		datalen = length;
+		return true;
+	case Code::repeat:
+		if(length == 0 || length > sizeof(pattern)) {
+			break;
+		}
+		if(!readVar(repeats) || !read(pattern, length)) {
+			return false;
+		}
+		datalen = length;
+		return true;
+	default:;
+	}
+
+	debug_w("[REC] Bad entry %s, %u", DisplayList::toString(hdr.code).c_str(), length);
+	return false;
+}
+
+bool RecordingRenderer::execute(Surface& surface)
+{
+	if(bytesPerPixel == 0) {
+		bytesPerPixel = getBytesPerPixel(surface.getPixelFormat());
+		object.stream->seekFrom(0, SeekOrigin::Start);
+	}
+
+	for(;;) {
+		if(windowPending) {
+			if(!surface.setAddrWindow(window)) {
+				return false;
+			}
+			windowPending = false;
+		}
+
+		if(repeats != 0) {
+			if(!surface.blockFill(pattern, datalen, repeats)) {
+				return false;
+			}
+			repeats = 0;
+			datalen = 0;
+		}
+
+		while(datalen != 0) {
+			uint16_t available;
+			auto buf = surface.getBuffer(bytesPerPixel, available);
+			if(buf == nullptr) {
+				return false;
+			}
+			auto len = std::min(datalen, available);
+			if(len > bytesPerPixel) {
+				len -= len % bytesPerPixel;
+			}
+			if(!read(buf, len)) {
+				debug_w("[REC] Truncated");
+				return true;
+			}
+			surface.commit(len);
+			datalen -= len;
+		}
+
+		if(!readEntry()) {
+			return true;
+		}
+	}
+}
+
 /* BlendRenderer */
 
 bool BlendRenderer::execute(Surface& surface)
@@ -1906,7 +3044,7 @@ bool BlendRenderer::execute(Surface& surface)
 		switch(nextState) {
 		case State::init:
 			pixelFormat = surface.getPixelFormat();
-			image = std::make_unique<MemoryImageObject>(pixelFormat, location.dest.size());
+			image.reset(new (RenderArena::transient) MemoryImageObject(pixelFormat, location.dest.size()));
 			if(!image->isValid()) {
 				image.reset();
 				// Insufficient RAM, fallback to standard render
@@ -37,6 +37,7 @@ bool SpiDisplay::begin(HSPI::PinSet pinSet, uint8_t chipSelect, uint8_t resetPin
 	setIoMode(HSPI::IoMode::SPIHD);
 
 	this->resetPin = resetPin;
+	addrWindow.invalidate();
 	if(resetPin != PIN_NONE) {
 		pinMode(resetPin, OUTPUT);
 		reset(false);
@@ -51,6 +52,7 @@ bool SpiDisplay::begin(HSPI::PinSet pinSet, uint8_t chipSelect, uint8_t resetPin
 
 void SpiDisplay::execute(const SpiDisplayList::Commands& commands, const FSTR::ObjectBase& data)
 {
+	addrWindow.invalidate();
 	SpiDisplayList src(commands, addrWindow, data);
 
 	uint32_t start{0};
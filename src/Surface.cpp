@@ -68,7 +68,7 @@ bool Surface::render(const Object& object, const Rect& location, std::unique_ptr
 	case Object::Kind::Line: {
 		// Draw horizontal or vertical lines
 		auto obj = static_cast<const LineObject&>(object);
-		if(obj.pen.isTransparent()) {
+		if(obj.pen.isTransparent() || obj.cap != LineCap::None) {
 			break;
 		}
 		Point pt1 = obj.pt1;
@@ -55,6 +55,20 @@ String toString(Graphics::Origin origin)
 	return CStringArray(strings)[unsigned(origin)];
 }
 
+String toString(Graphics::LineCap cap)
+{
+	switch(cap) {
+	case Graphics::LineCap::None:
+		return F("none");
+	case Graphics::LineCap::Square:
+		return F("square");
+	case Graphics::LineCap::Round:
+		return F("round");
+	default:
+		return nullptr;
+	}
+}
+
 String toString(Graphics::FontStyle style)
 {
 	switch(style) {
@@ -115,6 +129,100 @@ String Region::toString() const
 	return s;
 }
 
+/* DamageList */
+
+void DamageList::add(const Rect& rect)
+{
+	if(!rect || contains(rect)) {
+		return;
+	}
+
+	// Two areas combine without cost if they overlap or share a complete edge
+	auto canMerge = [](const Rect& r1, const Rect& r2) -> bool {
+		return r1.intersects(r2) || (r1 + r2).area() == r1.area() + r2.area();
+	};
+
+	Rect r{rect};
+	for(;;) {
+		// Absorbing a rectangle may cause overlap with others, so re-scan after each merge
+		unsigned i = 0;
+		while(i < count) {
+			if(canMerge(r, rects[i])) {
+				r += rects[i];
+				rects[i] = rects[--count];
+				i = 0;
+			} else {
+				++i;
+			}
+		}
+
+		if(count < maxRects) {
+			break;
+		}
+
+		// List is full: merge with whichever rectangle wastes the fewest pixels
+		unsigned best{0};
+		uint32_t bestWaste{UINT32_MAX};
+		for(i = 0; i < count; ++i) {
+			auto waste = (r + rects[i]).area() - r.area() - rects[i].area();
+			if(waste < bestWaste) {
+				best = i;
+				bestWaste = waste;
+			}
+		}
+		r += rects[best];
+		rects[best] = rects[--count];
+	}
+
+	rects[count++] = r;
+}
+
+bool DamageList::intersects(const Rect& rect) const
+{
+	if(!rect) {
+		return false;
+	}
+	for(auto& r : *this) {
+		if(r.intersects(rect)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DamageList::contains(const Rect& rect) const
+{
+	for(auto& r : *this) {
+		if(r.contains(rect)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+Rect DamageList::bounds() const
+{
+	Rect u;
+	for(auto& r : *this) {
+		u += r;
+	}
+	return u;
+}
+
+String DamageList::toString() const
+{
+	String s;
+	for(auto& r : *this) {
+		if(s) {
+			s += ", ";
+		}
+		s += '(';
+		s += r.toString();
+		s += ')';
+	}
+	return s;
+}
+
 String Location::toString() const
 {
 	String s;
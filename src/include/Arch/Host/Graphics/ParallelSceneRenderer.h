@@ -0,0 +1,80 @@
+/****
+ * ParallelSceneRenderer.h
+ *
+ * Copyright 2021 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the Sming-Graphics Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * @author: May 2021 - mikee47 <mike@sillyhouse.net>
+ *
+ ****/
+
+#pragma once
+
+#include <Graphics/Renderer.h>
+#include <vector>
+
+namespace Graphics
+{
+/**
+ * @brief Renders a scene in horizontal bands using multiple threads
+ *
+ * Host builds only. Each band is rasterized on its own thread into a private memory surface,
+ * then completed bands are written to the target surface in order.
+ * Intended for golden-image generation and throughput benchmarks.
+ *
+ * Simple shapes with solid colours are drawn concurrently. Objects which may read from shared
+ * streams (images, text, drawings, texture brushes, etc.) are drawn one thread at a time.
+ *
+ * As with `TiledSceneRenderer`, scenes containing objects which operate on display memory
+ * are drawn using a regular SceneRenderer. So are scenes containing custom objects,
+ * including controls, since their renderers may wait on callbacks from the main loop.
+ *
+ * @note Writing a band blocks until its thread has completed.
+ */
+class ParallelSceneRenderer : public Renderer
+{
+public:
+	/**
+	 * @param location
+	 * @param scene
+	 * @param threadCount Number of bands to render concurrently, 0 for one per CPU
+	 */
+	ParallelSceneRenderer(const Location& location, const SceneObject& scene, unsigned threadCount = 0);
+
+	~ParallelSceneRenderer();
+
+	bool execute(Surface& surface) override;
+
+private:
+	class Band;
+
+	enum class State {
+		init,
+		readback,
+		write,
+		done,
+	};
+
+	bool init(Surface& surface);
+
+	const SceneObject& scene;
+	std::unique_ptr<Rect[]> bounds; ///< Cached bounds for each scene object
+	std::vector<std::unique_ptr<Band>> bands;
+	std::unique_ptr<Renderer> renderer; ///< Display operations, i.e. readback
+	unsigned threadCount;
+	unsigned bandIndex{0};
+	State state{};
+};
+
+} // namespace Graphics
@@ -45,6 +45,7 @@ struct AddressWindow {
 	Rect bounds{};		///< y and h are updated by seek()
 	uint16_t column{0}; ///< Relative x position within window
 	Rect initial{};
+	Rect committed{}; ///< Window last sent to display hardware, empty if unknown
 	Mode mode{};
 
 	AddressWindow()
@@ -79,6 +80,18 @@ struct AddressWindow {
 		return *this;
 	}
 
+	/**
+	 * @brief Forget the window held by the display hardware
+	 *
+	 * Call when the display may have lost or re-interpreted its address window,
+	 * e.g. after reset or a change of orientation.
+	 * The next window is then sent in full.
+	 */
+	void invalidate()
+	{
+		committed = Rect{};
+	}
+
 	/**
 	 * @brief Get remaining pixels in window from current position
 	 */
@@ -31,7 +31,15 @@ namespace Graphics
 	XX(XNor, "dst = dst XOR (NOT src)")                                                                                \
 	XX(Mask, "dst = dst AND src")                                                                                      \
 	XX(Transparent, "Make nominated colour transparent")                                                               \
-	XX(Alpha, "Blend using alpha value")
+	XX(Alpha, "Blend using alpha value")                                                                               \
+	XX(Multiply, "dst = src * dst")                                                                                    \
+	XX(Screen, "dst = 1 - (1 - src) * (1 - dst)")                                                                      \
+	XX(Add, "dst = src + dst, saturated")                                                                              \
+	XX(Subtract, "dst = dst - src, saturated")                                                                         \
+	XX(Darken, "dst = min(src, dst)")                                                                                  \
+	XX(Lighten, "dst = max(src, dst)")                                                                                 \
+	XX(SrcOver, "Source over destination using alpha")                                                                 \
+	XX(DstOver, "Destination over source using alpha")
 
 /**
  * @brief Blend operations
@@ -118,7 +126,13 @@ public:
 class BlendTransparent : public BlendTemplate<BlendTransparent, BlendMode::Transparent>
 {
 public:
-	BlendTransparent(Color key) : key(key)
+	/**
+	 * @brief Constructor
+	 * @param key Transparent colour
+	 * @param exact By default, source pixels are drawn only if they're no brighter than the key colour.
+	 * Set this to make only pixels exactly matching the key transparent, which is much faster.
+	 */
+	BlendTransparent(Color key, bool exact = false) : key(key), exact(exact)
 	{
 	}
 
@@ -126,6 +140,7 @@ public:
 	{
 		Blend::write(meta);
 		meta.write("key", key);
+		meta.write("exact", exact);
 	}
 
 	static void blend(PixelFormat, PackedColor, uint8_t*, size_t)
@@ -135,13 +150,26 @@ public:
 
 	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length, Color key);
 
+	/**
+	 * @brief Copy all source pixels which don't exactly match the key colour
+	 *
+	 * Pixels are compared in packed format and runs of opaque pixels copied in one operation.
+	 * The alpha channel of BGRA32 pixels is ignored.
+	 */
+	static void blendExact(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length, Color key);
+
 	void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length) const
 	{
-		blend(format, srcptr, dstptr, length, key);
+		if(exact) {
+			blendExact(format, srcptr, dstptr, length, key);
+		} else {
+			blend(format, srcptr, dstptr, length, key);
+		}
 	}
 
 private:
 	Color key;
+	bool exact;
 };
 
 class BlendAlpha : public BlendTemplate<BlendAlpha, BlendMode::Alpha>
@@ -168,6 +196,21 @@ public:
 	static PackedColor blend(PixelFormat format, PackedColor src, PackedColor dst);
 	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
 	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length, uint8_t alpha);
+
+	/**
+	 * @brief Blend pixels using per-pixel alpha values
+	 * @param format Format of source and destination pixels
+	 * @param srcptr Source pixels
+	 * @param alpha Alpha value for each source pixel
+	 * @param dstptr Destination pixels
+	 * @param count Number of pixels
+	 * @param premultiplied Set if source colour channels have been multiplied by alpha
+	 *
+	 * Runs of fully opaque or fully transparent pixels are copied or skipped.
+	 */
+	static void blend(PixelFormat format, const uint8_t* srcptr, const uint8_t* alpha, uint8_t* dstptr, size_t count,
+					  bool premultiplied);
+
 	static uint16_t IRAM_ATTR blendRGB565(uint16_t src, uint16_t dst, uint8_t alpha);
 	static void IRAM_ATTR blendRGB565(uint16_t src, uint8_t* dstptr, size_t length, uint8_t alpha);
 	static void IRAM_ATTR blendRGB565(const uint8_t* srcptr, uint8_t* dstptr, size_t length, uint8_t alpha);
@@ -204,6 +247,75 @@ private:
 	uint8_t alpha; ///< 255 = source opaque, 0 = source invisible
 };
 
+class BlendMultiply : public BlendTemplate<BlendMultiply, BlendMode::Multiply>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+class BlendScreen : public BlendTemplate<BlendScreen, BlendMode::Screen>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+class BlendAdd : public BlendTemplate<BlendAdd, BlendMode::Add>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+class BlendSubtract : public BlendTemplate<BlendSubtract, BlendMode::Subtract>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+class BlendDarken : public BlendTemplate<BlendDarken, BlendMode::Darken>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+class BlendLighten : public BlendTemplate<BlendLighten, BlendMode::Lighten>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+/**
+ * @brief Porter-Duff 'source over' composition
+ *
+ * Colour sources use their alpha value. Buffer sources are opaque unless the format
+ * has an alpha channel (BGRA32), in which case destination alpha is also updated.
+ */
+class BlendSrcOver : public BlendTemplate<BlendSrcOver, BlendMode::SrcOver>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
+/**
+ * @brief Porter-Duff 'destination over' composition
+ *
+ * Source shows through wherever the destination is transparent.
+ * Only applicable to formats with an alpha channel (BGRA32), otherwise the destination is opaque
+ * and is left unchanged.
+ */
+class BlendDstOver : public BlendTemplate<BlendDstOver, BlendMode::DstOver>
+{
+public:
+	static void blend(PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length);
+	static void blend(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length);
+};
+
 } // namespace Graphics
 
 String toString(Graphics::BlendMode mode);
@@ -440,10 +440,34 @@ inline size_t writeColor(void* buffer, Color color, PixelFormat format, size_t c
 	return writeColor(buffer, pack(color, format), format, count);
 }
 
+/**
+ * @brief Function to convert a block of pixels between two specific formats
+ * @param srcData Source pixels
+ * @param dstBuffer Where to write converted pixels. May be the same as srcData,
+ * in which case it must be large enough for the converted pixels.
+ * @param numPixels Number of pixels to convert
+ * @retval size_t Number of bytes written
+ */
+using PixelConverter = size_t (*)(const void* srcData, void* dstBuffer, size_t numPixels);
+
+/**
+ * @brief Get function to convert between two pixel formats
+ * @param srcFormat Format of source pixels
+ * @param dstFormat Required format
+ * @retval PixelConverter Never null. Common conversions use specialised code.
+ *
+ * Use this to select a converter once before processing multiple blocks of pixels.
+ */
+PixelConverter getConverter(PixelFormat srcFormat, PixelFormat dstFormat);
+
 /**
  * @brief Convert block of data from one pixel format to another
  */
-size_t convert(const void* srcData, PixelFormat srcFormat, void* dstBuffer, PixelFormat dstFormat, size_t numPixels);
+inline size_t convert(const void* srcData, PixelFormat srcFormat, void* dstBuffer, PixelFormat dstFormat,
+					  size_t numPixels)
+{
+	return getConverter(srcFormat, dstFormat)(srcData, dstBuffer, numPixels);
+}
 
 } // namespace Graphics
 
@@ -45,6 +45,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return bounds;
+	}
+
 	virtual void draw(SceneObject& scene) const = 0;
 
 	void write(MetaWriter& meta) const override
@@ -91,14 +96,10 @@ public:
 			return;
 		}
 		bounds = r;
+		invalidateBounds();
 		flags += Flag::dirty;
 	}
 
-	Rect getBounds() const
-	{
-		return bounds;
-	}
-
 	bool isEnabled() const
 	{
 		return flags[Flag::enabled];
@@ -23,6 +23,7 @@
 
 #include <Graphics/AbstractDisplay.h>
 #include <Graphics/AddressWindow.h>
+#include <Graphics/SpiDisplayList.h>
 
 namespace Graphics
 {
@@ -32,10 +33,71 @@ namespace Display
  * @brief Null display device, discards data
  * 
  * Used for testing performance and algorithms.
+ *
+ * Optionally models an SPI display bus to estimate how long frames would take to send to real hardware.
  */
 class NullDevice : public AbstractDisplay
 {
 public:
+	/**
+	 * @brief Parameters for SPI bus model
+	 *
+	 * Defaults correspond to an ILI9341 display. See `SampleConfig.h`.
+	 */
+	struct BusTiming {
+		uint32_t writeSpeed{40000000}; ///< Clock frequency for commands and writes (Hz)
+		uint32_t readSpeed{27000000};  ///< Clock frequency for reads (Hz)
+		uint16_t requestOverhead{1000}; ///< Setup time for each SPI transaction (ns)
+	};
+
+	/**
+	 * @brief Simulated bus usage
+	 *
+	 * Times are accumulated in nanoseconds.
+	 */
+	struct BusStats : public Meta {
+		uint32_t lists;			///< Display lists executed
+		uint32_t requests;		///< SPI transactions
+		uint32_t commands;		///< Command bytes sent
+		uint32_t windowChanges; ///< setColumn/setRow commands sent
+		uint32_t reads;			///< Read transactions
+		uint32_t bytesOut;		///< Parameter and pixel data written
+		uint32_t bytesIn;		///< Pixel data read
+		uint64_t commandTime;	///< Sending commands and their parameters, excluding address window
+		uint64_t addressTime;	///< Sending address window parameters
+		uint64_t writeTime;		///< Writing pixel data
+		uint64_t readTime;		///< Reading pixel data, including dummy cycles
+		uint64_t overheadTime;	///< Transaction setup
+
+		/**
+		 * @brief Get total time the bus was occupied
+		 * @retval uint64_t Time in nanoseconds
+		 *
+		 * If stats are snapshot for each frame this gives the estimated frame time.
+		 */
+		uint64_t getBusTime() const
+		{
+			return commandTime + addressTime + writeTime + readTime + overheadTime;
+		}
+
+		/**
+		 * @brief Get proportion of bus time spent transferring pixel data
+		 * @retval unsigned Percentage
+		 */
+		unsigned getPixelDataShare() const
+		{
+			auto busTime = getBusTime();
+			return busTime ? (100 * (writeTime + readTime) + busTime / 2) / busTime : 0;
+		}
+
+		String getTypeStr() const
+		{
+			return F("NullDevice::BusStats");
+		}
+
+		void write(MetaWriter& meta) const;
+	};
+
 	NullDevice(uint16_t width = 240, uint16_t height = 320, PixelFormat format = PixelFormat::RGB565)
 		: nativeSize(width, height), pixelFormat(format)
 	{
@@ -96,12 +158,86 @@ public:
 
 	Surface* createSurface(size_t bufferSize = 0) override;
 
+	/**
+	 * @brief Enable SPI bus model
+	 * @param timing Bus parameters
+	 *
+	 * Surfaces created after this call build display lists as for a MIPI display.
+	 * Executing a list accounts for each SPI transaction it generates.
+	 */
+	void enableBusModel(const BusTiming& timing)
+	{
+		busTiming = timing;
+		busModel = true;
+	}
+
+	void enableBusModel()
+	{
+		enableBusModel(BusTiming{});
+	}
+
+	/**
+	 * @brief Revert to discarding data without building display lists
+	 *
+	 * Affects surfaces created after this call.
+	 */
+	void disableBusModel()
+	{
+		busModel = false;
+	}
+
+	bool isBusModelEnabled() const
+	{
+		return busModel;
+	}
+
+	/**
+	 * @brief Set run-length encoding for surfaces subsequently created by the bus model
+	 * @param minRepeats Shortest run of identical pixels to encode, 0 to disable (the default)
+	 * @see MipiDisplay::setRunLengthEncoding()
+	 */
+	void setRunLengthEncoding(uint8_t minRepeats)
+	{
+		rleMinRepeats = minRepeats;
+	}
+
+	uint8_t getRunLengthEncoding() const
+	{
+		return rleMinRepeats;
+	}
+
+	/**
+	 * @brief Get bus usage accumulated since the last snapshot
+	 */
+	const BusStats& getBusStats() const
+	{
+		return busStats;
+	}
+
+	/**
+	 * @brief Get bus usage and start a new collection period
+	 *
+	 * For example, call when each frame has been rendered to obtain the estimated frame time.
+	 */
+	BusStats snapshotBusStats()
+	{
+		BusStats s = busStats;
+		busStats = BusStats{};
+		return s;
+	}
+
 private:
 	friend class NullSurface;
 
+	void execute(SpiDisplayList& list);
+
 	Size nativeSize{};
 	PixelFormat pixelFormat{};
 	AddressWindow addrWindow{};
+	BusTiming busTiming{};
+	BusStats busStats{};
+	bool busModel{false};
+	uint8_t rleMinRepeats{0};
 };
 
 } // namespace Display
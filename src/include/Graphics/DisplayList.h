@@ -26,6 +26,8 @@
 #include "Buffer.h"
 #include "Blend.h"
 #include <FlashString/Array.hpp>
+#include <Print.h>
+#include <Data/Stream/DataSourceStream.h>
 #include <memory>
 
 #define DEFINE_RB_COMMAND(cmd, len, ...) uint8_t(uint8_t(DisplayList::Code::command) | (len << 4)), cmd, ##__VA_ARGS__,
@@ -167,6 +169,77 @@ public:
 
 	static String toString(Code code);
 
+	static constexpr unsigned codeCount{
+#define XX(code, arglen, desc) 1 +
+		GRAPHICS_DL_COMMAND_LIST(XX)
+#undef XX
+		0};
+
+#ifdef ENABLE_GRAPHICS_DL_STATS
+	/**
+	 * @brief Usage information for one type of list entry
+	 */
+	struct CodeStats : public Meta {
+		uint32_t count;	///< Number of entries
+		uint32_t bytes;	///< Payload stored in lists, or read from display
+		uint32_t sent; ///< Payload transferred, including repeats and setColumn/setRow command bytes
+
+		String getTypeStr() const
+		{
+			return F("CodeStats");
+		}
+
+		void write(MetaWriter& meta) const
+		{
+			meta.write("count", count);
+			meta.write("bytes", bytes);
+			meta.write("sent", sent);
+		}
+	};
+
+	/**
+	 * @brief Accumulated usage for all display lists
+	 * @see See `getStats()`
+	 */
+	struct Stats : public Meta {
+		CodeStats codes[codeCount];
+		uint32_t lists;			 ///< Number of lists filled
+		uint32_t listBytes;		 ///< Total list buffer usage
+		uint32_t windowChanges;	 ///< Address window changes which sent at least one command
+		uint32_t elidedCommands; ///< setColumn/setRow commands not required
+
+		String getTypeStr() const
+		{
+			return F("DisplayList::Stats");
+		}
+
+		void write(MetaWriter& meta) const;
+	};
+
+	/**
+	 * @brief Get usage information accumulated since the last snapshot
+	 *
+	 * Lists are accounted for when they are reset after use.
+	 * Requires ENABLE_GRAPHICS_DL_STATS=1.
+	 */
+	static const Stats& getStats()
+	{
+		return stats;
+	}
+
+	/**
+	 * @brief Get usage information and start a new collection period
+	 *
+	 * For example, call when each frame has been rendered to determine how it was sent to the display.
+	 */
+	static Stats snapshotStats()
+	{
+		Stats s = stats;
+		stats = Stats{};
+		return s;
+	}
+#endif
+
 	/**
 	 * @brief Each list entry starts with a header
 	 * 
@@ -298,6 +371,16 @@ public:
 		return size;
 	}
 
+	/**
+	 * @brief Get number of setColumn/setRow commands omitted because the display window was already set
+	 *
+	 * This is a running total for the lifetime of the list.
+	 */
+	uint32_t getElidedCommands() const
+	{
+		return elidedCommands;
+	}
+
 	/**
 	 * @brief Get read-only pointer to start of buffer
 	 */
@@ -336,6 +419,17 @@ public:
 	 */
 	void commit(uint16_t length);
 
+	/**
+	 * @brief Enable run-length encoding of committed pixel data
+	 * @param bytesPerPixel Size of pixels written to the display, 0 to disable
+	 * @param minRepeats Shortest run of identical pixels to store as a repeat chunk
+	 *
+	 * Data added using `getBuffer` and `commit` is scanned for runs of identical pixels,
+	 * which are stored as repeat chunks as used by `blockFill`.
+	 * This saves list space when images or text contain areas of solid colour.
+	 */
+	void setRunLengthEncoding(uint8_t bytesPerPixel, uint8_t minRepeats = 8);
+
 	/**
 	 * @brief Write command with 1-4 bytes of parameter data
 	 */
@@ -527,6 +621,11 @@ protected:
 	}
 
 	void internalSetAddrWindow(const Rect& rect);
+	uint16_t getMinRunLength() const;
+#ifdef ENABLE_GRAPHICS_DL_STATS
+	void updateStats();
+#endif
+	void commitEncoded(uint16_t length);
 
 	/**
 	 * @brief Read block of data from buffer
@@ -564,13 +663,157 @@ protected:
 	uint16_t offset{0}; ///< Current read position
 
 private:
+#ifdef ENABLE_GRAPHICS_DL_STATS
+	static Stats stats;
+#endif
 	AddressWindow& addrWindow;
+	uint32_t elidedCommands{0};
 	uint16_t capacity;
 	SharedBuffer lockedBuffers[maxLockedBuffers];
 #ifdef ENABLE_GRAPHICS_RAM_TRACKING
 	size_t maxBufferUsage{0};
 #endif
 	uint8_t lockCount{0};
+	uint8_t rlePixelBytes{0};
+	uint8_t rleMinRepeats{0};
+
+	friend class DisplayListRecorder;
+};
+
+/**
+ * @brief Captures display list content for later playback
+ *
+ * Lists are recorded in one of two forms, using the same encoding as DisplayList.
+ *
+ * A relocatable recording has externally buffered data copied inline and addresses adjusted to be relative
+ * to the display origin. It may be stored in RAM (e.g. MemoryDataStream) or in a file, and played back using
+ * a `RecordingObject`. Repeated blocks longer than `RecordingObject::maxRepeatLength` are stored as data.
+ * Only write operations can be recorded. Reads and callbacks (e.g. for blending)
+ * refer to memory which will not exist at playback time, so any list containing them invalidates the recording.
+ *
+ * An exact recording preserves the list encoding, for offline replay and benchmarking,
+ * so recordings made with different library versions can be compared byte for byte.
+ * Only references to memory are changed as these have no meaning outside the session:
+ *
+ * - writeDataBuffer entries are stored as writeData with the data inline
+ * - read and readStart entries omit the buffer address
+ * - callback entries omit the function address and alignment padding
+ *
+ * The recording starts with a `Header`, followed by each list terminated with a `none` entry.
+ * Use `load()` to re-create lists for playback.
+ *
+ * Lists must be recorded after they have been executed, as writeDataBuffer content
+ * may be filled in by read callbacks during execution.
+ */
+class DisplayListRecorder
+{
+public:
+	enum class Mode {
+		relocatable, ///< For playback using `RecordingObject`
+		exact,		 ///< Preserve list encoding for offline replay
+	};
+
+	/**
+	 * @brief Start of an exact recording
+	 */
+	struct Header {
+		static constexpr uint32_t magicValue{0x434c4447}; ///< "GDLC"
+		static constexpr uint8_t currentVersion{1};
+
+		uint32_t magic;
+		uint8_t version;
+		PixelFormat pixelFormat; ///< Format of pixel data written to display
+		uint16_t reserved;
+	};
+
+	/**
+	 * @param out Where to write the recording
+	 * @param mode Form of recording
+	 * @param pixelFormat Display pixel format, stored in header for exact recordings
+	 */
+	DisplayListRecorder(Print& out, Mode mode = Mode::relocatable, PixelFormat pixelFormat = PixelFormat::None);
+
+	/**
+	 * @brief Append content of a display list to the recording
+	 * @param list The list to record, must have been executed and not yet reset
+	 * @param origin Display address corresponding to (0, 0), ignored for exact recordings
+	 * @retval bool false if the list cannot be recorded
+	 */
+	bool record(DisplayList& list, Point origin = {});
+
+	/**
+	 * @brief Determine if recording is usable
+	 * @retval bool false if any list could not be recorded, or output failed
+	 */
+	bool isValid() const
+	{
+		return valid;
+	}
+
+	Mode getMode() const
+	{
+		return mode;
+	}
+
+	/**
+	 * @brief Get area of display covered by a relocatable recording
+	 */
+	const Rect& getBounds() const
+	{
+		return bounds;
+	}
+
+	/**
+	 * @brief Get number of bytes written to the recording
+	 */
+	size_t getSize() const
+	{
+		return size;
+	}
+
+	/**
+	 * @brief Get number of lists recorded
+	 */
+	unsigned getListCount() const
+	{
+		return listCount;
+	}
+
+	/**
+	 * @brief Read and verify header of an exact recording
+	 * @param in Stream positioned at start of recording
+	 * @param header (OUT)
+	 * @retval bool false if this is not an exact recording, or is an unsupported version
+	 */
+	static bool readHeader(IDataSourceStream& in, Header& header);
+
+	/**
+	 * @brief Re-create the next list from an exact recording
+	 * @param in Stream positioned after the header or the previous list
+	 * @param list Existing content is discarded
+	 * @param readBuffer Receives data for read entries, must be large enough for any single read
+	 * @param callback Invoked in place of recorded callbacks, with the recorded parameter data
+	 * @retval bool false at end of recording, or if the list is too small
+	 */
+	static bool load(IDataSourceStream& in, DisplayList& list, void* readBuffer, DisplayList::Callback callback);
+
+private:
+	void recordRelocatable(DisplayList& list, Point origin);
+	void recordExact(DisplayList& list);
+	void writeRepeatAsData(const DisplayList::Entry& entry);
+	void addWindowToBounds();
+	void write(const void* data, size_t length);
+	void writeHeader(DisplayList::Code code, uint16_t length);
+	void writeVar(uint16_t value);
+
+	Print& out;
+	Rect bounds;
+	Rect window; ///< Persists between lists as a list may set only one axis
+	size_t size{0};
+	unsigned listCount{0};
+	Mode mode;
+	bool windowChanged{false}; ///< Window not yet added to bounds
+	bool valid{true};
 };
 
 } // namespace Graphics
@@ -151,4 +151,30 @@ private:
 	IFS::FileStream& file;
 };
 
+/**
+ * @brief Surface for an image with a colour palette
+ *
+ * Pixels are written and read in the image's pixel format and translated to or from palette indices.
+ */
+class IndexedImageSurface : public ImageSurface
+{
+public:
+	IndexedImageSurface(IndexedImageObject& image, const Blend* blend, size_t bufferSize)
+		: ImageSurface(image, image.getPixelFormat(), bufferSize), blend(blend)
+	{
+	}
+
+	Type getType() const override
+	{
+		return Type::Memory;
+	}
+
+protected:
+	void read(uint32_t offset, void* buffer, size_t length) override;
+	void write(uint32_t offset, const void* data, size_t length) override;
+
+private:
+	const Blend* blend;
+};
+
 } // namespace Graphics
@@ -133,6 +133,41 @@ public:
 		return scrollOffset;
 	}
 
+	/**
+	 * @brief Set run-length encoding for surfaces subsequently created by this display
+	 * @param minRepeats Shortest run of identical pixels to encode, 0 to disable (the default)
+	 * @see DisplayList::setRunLengthEncoding()
+	 */
+	void setRunLengthEncoding(uint8_t minRepeats)
+	{
+		rleMinRepeats = minRepeats;
+	}
+
+	uint8_t getRunLengthEncoding() const
+	{
+		return rleMinRepeats;
+	}
+
+	/**
+	 * @brief Capture output from all surfaces of this display
+	 * @param recorder Receives every display list once it has been executed, nullptr to stop recording
+	 *
+	 * Display lists are still executed as normal whilst recording.
+	 * Lists are recorded when the surface is reset, so this must happen before it is destroyed.
+	 * Scrolling should not be in use as recorded addresses are not adjusted for it.
+	 */
+	void setRecorder(DisplayListRecorder* recorder)
+	{
+		// Ensure the recording starts with a complete address window
+		addrWindow.invalidate();
+		this->recorder = recorder;
+	}
+
+	DisplayListRecorder* getRecorder() const
+	{
+		return recorder;
+	}
+
 protected:
 	/**
 	 * @brief Perform display-specific initialisation
@@ -189,8 +224,10 @@ protected:
 private:
 	static bool transferBeginEnd(HSPI::Request& request);
 
+	DisplayListRecorder* recorder{nullptr};
 	uint8_t dcPin{PIN_NONE};
 	bool dcState{};
+	uint8_t rleMinRepeats{0};
 	uint16_t scrollOffset{0};
 };
 
@@ -212,9 +249,16 @@ public:
 		};
 	}
 
-	void reset() override
+	void reset() override;
+
+	/**
+	 * @brief Enable run-length encoding of pixel data written to this surface
+	 * @param minRepeats Shortest run of identical pixels to encode, 0 to disable
+	 * @see DisplayList::setRunLengthEncoding()
+	 */
+	void setRunLengthEncoding(uint8_t minRepeats)
 	{
-		displayList.reset();
+		displayList.setRunLengthEncoding(minRepeats ? getBytesPerPixel(getPixelFormat()) : 0, minRepeats);
 	}
 
 	Size getSize() const override
@@ -271,6 +315,7 @@ public:
 protected:
 	MipiDisplay& display;
 	SpiDisplayList displayList;
+	bool presented{false}; ///< List has been passed to display for execution
 };
 
 } // namespace Graphics
@@ -23,6 +23,7 @@
 
 #include "Asset.h"
 #include "Blend.h"
+#include "RenderArena.h"
 #include <Data/Stream/LimitedMemoryStream.h>
 #include <Data/Stream/MemoryDataStream.h>
 #include <FlashString/Stream.hpp>
@@ -52,12 +53,15 @@ namespace Graphics
 	XX(Reference)                                                                                                      \
 	XX(Surface)                                                                                                        \
 	XX(Copy)                                                                                                           \
-	XX(Scroll)
+	XX(Scroll)                                                                                                         \
+	XX(Recording)                                                                                                      \
+	XX(FilledPolygon)
 
 class MetaWriter;
 class Brush;
 class Surface;
 class FileImageSurface;
+class IndexedImageSurface;
 
 /**
  * @brief Virtual base class to manage rendering of various types of information to a surface
@@ -80,6 +84,20 @@ public:
 	{
 	}
 
+	/*
+	 * Renderers are allocated from the current render arena, if there is one
+	 */
+
+	static void* operator new(size_t size)
+	{
+		return RenderArena::alloc(size);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		RenderArena::free(ptr);
+	}
+
 	/**
 	 * @brief Called to do some writing to the surface
 	 * @retval bool true when rendering is complete, false if more work to be done
@@ -107,6 +125,32 @@ public:
 
 	virtual Kind kind() const = 0;
 
+	/*
+	 * Objects normally live on the heap. Those created by renderers for their own use,
+	 * and released before rendering completes, may use `new (RenderArena::transient) ...`
+	 * to allocate from the current render arena.
+	 */
+
+	static void* operator new(size_t size)
+	{
+		return ::operator new(size);
+	}
+
+	static void* operator new(size_t size, RenderArena::Transient)
+	{
+		return RenderArena::alloc(size);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		RenderArena::free(ptr);
+	}
+
+	static void operator delete(void* ptr, RenderArena::Transient)
+	{
+		RenderArena::free(ptr);
+	}
+
 	/**
 	 * @brief Create a software renderer for this object
 	 * @param location
@@ -116,6 +160,30 @@ public:
 	 */
 	virtual Renderer* createRenderer(const Location& location) const = 0;
 
+	/**
+	 * @brief Get the area this object may draw into, relative to its location
+	 * @retval Rect An empty rectangle indicates the extent is unknown
+	 *
+	 * Used for culling and damage tracking so must not under-estimate.
+	 * The result is cached: call `invalidateBounds()` after modifying the object.
+	 */
+	Rect getBounds() const
+	{
+		if(!boundsValid) {
+			cachedBounds = calculateBounds();
+			boundsValid = true;
+		}
+		return cachedBounds;
+	}
+
+	/**
+	 * @brief Discard cached bounds so they're re-calculated on next call to `getBounds()`
+	 */
+	void invalidateBounds() const
+	{
+		boundsValid = false;
+	}
+
 	bool operator==(const Object& other) const
 	{
 		return this == &other;
@@ -125,6 +193,19 @@ public:
 
 	virtual String getTypeStr() const;
 	virtual void write(MetaWriter& meta) const = 0;
+
+protected:
+	/**
+	 * @brief Implementations override this to provide object extent
+	 */
+	virtual Rect calculateBounds() const
+	{
+		return Rect{};
+	}
+
+private:
+	mutable Rect cachedBounds{};
+	mutable bool boundsValid{false};
 };
 
 template <Object::Kind object_kind> class ObjectTemplate : public Object
@@ -168,6 +249,16 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	/*
+	 * Note: bounds of the referenced object are cached separately,
+	 * so if it's modified both objects require invalidation.
+	 */
+	Rect calculateBounds() const override
+	{
+		auto r = object.getBounds();
+		return r ? intersect(r + pos.topLeft(), pos) : pos;
+	}
+
 	const Object& object;
 	Rect pos;
 	Point sourceOffset;
@@ -192,6 +283,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return Rect(point, 1, 1);
+	}
+
 	Brush brush;
 	Point point;
 };
@@ -221,6 +317,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return rect;
+	}
+
 	Pen pen;
 	Rect rect;
 	uint8_t radius{0};
@@ -251,6 +352,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return rect;
+	}
+
 	const Blend* blender{nullptr};
 	Brush brush;
 	Rect rect;
@@ -267,7 +373,7 @@ public:
 	{
 	}
 
-	LineObject(Pen pen, Point pt1, Point pt2) : pen(pen), pt1(pt1), pt2(pt2)
+	LineObject(Pen pen, Point pt1, Point pt2, LineCap cap = LineCap::None) : pen(pen), pt1(pt1), pt2(pt2), cap(cap)
 	{
 	}
 
@@ -284,13 +390,23 @@ public:
 		meta.write("pen", pen);
 		meta.write("pt1", pt1);
 		meta.write("pt2", pt2);
+		if(cap != LineCap::None) {
+			meta.write("cap", cap);
+		}
+		if(antialias) {
+			meta.write("antialias", antialias);
+		}
 	}
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override;
+
 	Pen pen{};
 	Point pt1{};
 	Point pt2{};
+	LineCap cap{LineCap::None}; ///< How ends are drawn when pen width is greater than 1
+	bool antialias{false};		///< Smooth edges, supported for solid pens of width 1
 };
 
 /**
@@ -301,6 +417,9 @@ public:
  * 
  * Setting the `connected` property to false allows the lines to be discontinuous,
  * so a line is drawn between points 0-1, 2-3, 3-4, etc.
+ *
+ * For wide pens the `cap` property is applied to every line, so also determines how connected
+ * lines are joined: round caps give round joins whilst square caps fill out the corners.
  */
 class PolylineObject : public ObjectTemplate<Object::Kind::Polyline>
 {
@@ -359,16 +478,63 @@ public:
 	{
 		meta.write("pen", pen);
 		meta.writeArray("points", "Point", points.get(), numPoints);
+		if(cap != LineCap::None) {
+			meta.write("cap", cap);
+		}
 	}
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override;
+
 	Pen pen;
 	std::unique_ptr<Point[]> points;
 	uint16_t numPoints;
+	LineCap cap{LineCap::None};
 	bool connected{true};
 };
 
+/**
+ * @brief A filled polygon
+ *
+ * The polygon is closed automatically so the last point need not repeat the first one.
+ * Self-intersecting polygons are filled using the even-odd rule.
+ */
+class FilledPolygonObject : public ObjectTemplate<Object::Kind::FilledPolygon>
+{
+public:
+	FilledPolygonObject(Brush brush, size_t count)
+		: brush(brush), points(std::make_unique<Point[]>(count)), numPoints(count)
+	{
+	}
+
+	template <typename... ParamTypes>
+	FilledPolygonObject(Brush brush, ParamTypes... params) : brush(brush), numPoints(sizeof...(ParamTypes))
+	{
+		this->points.reset(new Point[sizeof...(ParamTypes)]{params...});
+	}
+
+	Point operator[](unsigned index) const
+	{
+		assert(index < numPoints);
+		return points[index];
+	}
+
+	void write(MetaWriter& meta) const override
+	{
+		meta.write("brush", brush);
+		meta.writeArray("points", "Point", points.get(), numPoints);
+	}
+
+	Renderer* createRenderer(const Location& location) const override;
+
+	Rect calculateBounds() const override;
+
+	Brush brush;
+	std::unique_ptr<Point[]> points;
+	uint16_t numPoints;
+};
+
 /**
  * @brief A circle outline
  */
@@ -401,13 +567,26 @@ public:
 		meta.write("pen", pen);
 		meta.write("centre", centre);
 		meta.write("radius", radius);
+		if(antialias) {
+			meta.write("antialias", antialias);
+		}
 	}
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		// Renderer draws pixels at centre +/- radius
+		auto r = getRect();
+		++r.w;
+		++r.h;
+		return r;
+	}
+
 	Pen pen;
 	Point centre;
 	uint16_t radius;
+	bool antialias{false}; ///< Smooth edges, supported for solid pens of width 1
 };
 
 /**
@@ -448,6 +627,15 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		// Renderer draws pixels at centre +/- radius
+		auto r = getRect();
+		++r.w;
+		++r.h;
+		return r;
+	}
+
 	Brush brush;
 	Point centre;
 	uint16_t radius;
@@ -472,12 +660,21 @@ public:
 	{
 		meta.write("pen", pen);
 		meta.write("rect", rect);
+		if(antialias) {
+			meta.write("antialias", antialias);
+		}
 	}
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return rect;
+	}
+
 	Pen pen;
 	Rect rect;
+	bool antialias{false}; ///< Smooth edges, supported for solid pens of width 1
 };
 
 /**
@@ -503,6 +700,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return rect;
+	}
+
 	Brush brush;
 	Rect rect;
 };
@@ -528,6 +730,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return rect;
+	}
+
 	Pen pen;
 	Rect rect;
 	int16_t startAngle;
@@ -555,6 +762,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return rect;
+	}
+
 	Brush brush;
 	Rect rect;
 	int16_t startAngle;
@@ -567,6 +779,15 @@ public:
 class ImageObject : public ObjectTemplate<Object::Kind::Image>
 {
 public:
+	/**
+	 * @brief How per-pixel alpha values are applied
+	 */
+	enum class AlphaMode {
+		none,		   ///< Image is opaque
+		straight,	  ///< Colour channels are independent of alpha
+		premultiplied, ///< Colour channels have been multiplied by alpha
+	};
+
 	ImageObject(Size size) : imageSize(size)
 	{
 	}
@@ -578,6 +799,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return Rect(imageSize);
+	}
+
 	Size getSize() const
 	{
 		return imageSize;
@@ -614,6 +840,30 @@ public:
 	 */
 	virtual size_t readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const = 0;
 
+	/**
+	 * @brief Determine whether image has per-pixel alpha
+	 */
+	virtual AlphaMode getAlphaMode() const
+	{
+		return AlphaMode::none;
+	}
+
+	/**
+	 * @brief Read pixels in requested format with their alpha values
+	 * @param loc Start position
+	 * @param format Required pixel format
+	 * @param buffer Buffer for pixels
+	 * @param alpha Buffer for alpha values, one per pixel
+	 * @param width Number of pixels to read
+	 * @retval size_t Number of bytes written to pixel buffer
+	 */
+	virtual size_t readAlphaPixels(const Location& loc, PixelFormat format, void* buffer, uint8_t* alpha,
+								   uint16_t width) const
+	{
+		memset(alpha, 0xff, width);
+		return readPixels(loc, format, buffer, width);
+	}
+
 protected:
 	Size imageSize{};
 };
@@ -701,18 +951,27 @@ private:
 class RawImageObject : public StreamImageObject
 {
 public:
-	RawImageObject(IDataSourceStream* image, PixelFormat format, Size size)
-		: StreamImageObject(image, size), pixelFormat(format)
+	/**
+	 * @brief Constructor
+	 * @param image Pixel data
+	 * @param format Pixel format
+	 * @param size Image dimensions
+	 * @param alphaMode For images with per-pixel alpha. BGRA32 pixels use their alpha channel,
+	 * other formats have an 8-bit alpha value following each pixel.
+	 */
+	RawImageObject(IDataSourceStream* image, PixelFormat format, Size size, AlphaMode alphaMode = AlphaMode::none)
+		: StreamImageObject(image, size), pixelFormat(format), alphaMode(alphaMode)
 	{
 	}
 
-	RawImageObject(const FSTR::String& image, PixelFormat format, Size size)
-		: RawImageObject(new FSTR::Stream(image), format, size)
+	RawImageObject(const FSTR::String& image, PixelFormat format, Size size, AlphaMode alphaMode = AlphaMode::none)
+		: RawImageObject(new FSTR::Stream(image), format, size, alphaMode)
 	{
 	}
 
 	RawImageObject(const Resource::ImageResource& image)
-		: RawImageObject(Resource::createSubStream(image.bmOffset, image.bmSize), image.getFormat(), image.getSize())
+		: RawImageObject(Resource::createSubStream(image.bmOffset, image.bmSize), image.getFormat(), image.getSize(),
+						 getAlphaMode(image.getFlags()))
 	{
 	}
 
@@ -720,6 +979,9 @@ public:
 	{
 		StreamImageObject::write(meta);
 		meta.write("pixelFormat", pixelFormat);
+		if(alphaMode != AlphaMode::none) {
+			meta.write("premultiplied", alphaMode == AlphaMode::premultiplied);
+		}
 	}
 
 	bool init() override
@@ -732,10 +994,46 @@ public:
 		return pixelFormat;
 	}
 
-	size_t readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const override;
+	size_t readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const override
+	{
+		return readPixelData(loc, format, buffer, nullptr, width);
+	}
+
+	AlphaMode getAlphaMode() const override
+	{
+		return alphaMode;
+	}
+
+	size_t readAlphaPixels(const Location& loc, PixelFormat format, void* buffer, uint8_t* alpha,
+						   uint16_t width) const override
+	{
+		return readPixelData(loc, format, buffer, alpha, width);
+	}
 
 protected:
 	PixelFormat pixelFormat;
+	AlphaMode alphaMode;
+
+private:
+	static AlphaMode getAlphaMode(Resource::ImageResource::Flags flags)
+	{
+		using Flag = Resource::ImageResource::Flag;
+		if(!flags[Flag::alpha]) {
+			return AlphaMode::none;
+		}
+		return flags[Flag::premultiplied] ? AlphaMode::premultiplied : AlphaMode::straight;
+	}
+
+	/**
+	 * @brief Size of each stored pixel, including any alpha value
+	 */
+	uint8_t getStride() const
+	{
+		auto bpp = getBytesPerPixel(pixelFormat);
+		return (alphaMode == AlphaMode::none || pixelFormat == PixelFormat::BGRA32) ? bpp : bpp + 1;
+	}
+
+	size_t readPixelData(const Location& loc, PixelFormat format, void* buffer, uint8_t* alpha, uint16_t width) const;
 };
 
 /**
@@ -840,6 +1138,129 @@ private:
 	size_t imageBytes;
 };
 
+/**
+ * @brief Image stored in RAM as indices into a colour palette
+ *
+ * Pixels are stored as 1, 2, 4 or 8-bit values so require 2-16 times less memory than RGB565.
+ * Rows start on a byte boundary.
+ *
+ * Surfaces render in the given pixel format, with each pixel written mapped to the nearest palette entry.
+ * Pixels are expanded via the palette when read.
+ */
+class IndexedImageObject : public ImageObject, public RenderTarget
+{
+public:
+	/**
+	 * @brief Constructor
+	 * @param format Format used for rendering, typically that of the display
+	 * @param size Image dimensions
+	 * @param bitsPerPixel One of 1, 2, 4 or 8
+	 * @param palette Initial colours. Must contain `1 << bitsPerPixel` entries.
+	 */
+	IndexedImageObject(PixelFormat format, Size size, uint8_t bitsPerPixel, const Color* palette);
+
+	~IndexedImageObject()
+	{
+		debug_i("[IMG] %p, destroyed", imageData.get());
+	}
+
+	void write(MetaWriter& meta) const override
+	{
+		ImageObject::write(meta);
+		meta.write("pixelFormat", pixelFormat);
+		meta.write("bitsPerPixel", bitsPerPixel);
+	}
+
+	Surface* createSurface(const Blend* blend, size_t bufferSize = 0);
+
+	bool isValid() const
+	{
+		return imageData != nullptr;
+	}
+
+	uint8_t getBitsPerPixel() const
+	{
+		return bitsPerPixel;
+	}
+
+	uint16_t getPaletteSize() const
+	{
+		return 1U << bitsPerPixel;
+	}
+
+	Color getPaletteColor(uint8_t index) const
+	{
+		return palette[index];
+	}
+
+	/**
+	 * @brief Change a palette entry
+	 * @note Existing pixels using this entry change colour when next read
+	 */
+	void setPaletteColor(uint8_t index, Color color);
+
+	/* ImageObject */
+
+	bool init() override
+	{
+		return true;
+	}
+
+	PixelFormat getPixelFormat() const override
+	{
+		return pixelFormat;
+	}
+
+	size_t readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const override;
+
+	/* RenderTarget */
+
+	Size getSize() const override
+	{
+		return imageSize;
+	}
+
+	Surface* createSurface(size_t bufferSize = 0) override
+	{
+		return createSurface(nullptr, bufferSize);
+	}
+
+private:
+	friend IndexedImageSurface;
+
+	uint8_t getIndex(uint16_t x, uint16_t y) const
+	{
+		auto pos = x * bitsPerPixel;
+		auto shift = 8 - bitsPerPixel - (pos & 7);
+		return (imageData[y * stride + pos / 8] >> shift) & pixelMask;
+	}
+
+	void setIndex(uint16_t x, uint16_t y, uint8_t index)
+	{
+		auto pos = x * bitsPerPixel;
+		auto shift = 8 - bitsPerPixel - (pos & 7);
+		auto& c = imageData[y * stride + pos / 8];
+		c = (c & ~(pixelMask << shift)) | (index << shift);
+	}
+
+	uint8_t findColor(PackedColor color) const;
+
+	/*
+	 * Surface access. Pixels are addressed linearly from top-left.
+	 */
+	void getPixels(uint32_t pixel, uint8_t* buffer, size_t count) const;
+	void setPixels(uint32_t pixel, const uint8_t* data, size_t count);
+
+	PixelFormat pixelFormat;
+	uint8_t bitsPerPixel;
+	uint8_t pixelMask;
+	uint16_t stride; ///< Bytes per row
+	std::unique_ptr<uint8_t[]> imageData;
+	std::unique_ptr<Color[]> palette;
+	std::unique_ptr<PackedColor[]> packedPalette; ///< Palette in pixelFormat
+	mutable uint8_t lastIndex{0};				  ///< Speeds up palette lookup for runs of one colour
+};
+
 /**
  * @brief A character glyph image
  *
@@ -934,6 +1355,8 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override;
+
 	class Element : public LinkedObjectTemplate<Element>, public Meta
 	{
 	public:
@@ -1112,6 +1535,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return dest;
+	}
+
 	/* Meta */
 
 	void write(MetaWriter& meta) const override;
@@ -1133,6 +1561,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return Rect(dest, source.size());
+	}
+
 	/* Meta */
 
 	void write(MetaWriter& meta) const override
@@ -1158,6 +1591,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return area;
+	}
+
 	/* Meta */
 
 	void write(MetaWriter& meta) const override
@@ -1176,6 +1614,52 @@ public:
 	Color fill;
 };
 
+/**
+ * @brief Display output previously captured using a `DisplayListRecorder`
+ *
+ * Playback writes the recorded pixel data straight to the target surface so no rasterization is required.
+ * Recorded addresses are relative to the render location.
+ * The stream must support seeking if the object is to be drawn more than once.
+ */
+class RecordingObject : public ObjectTemplate<Object::Kind::Recording>
+{
+public:
+	/**
+	 * @brief Longest block of data played back as a repeat
+	 *
+	 * `DisplayListRecorder` stores longer repeated blocks as plain data.
+	 */
+	static constexpr uint8_t maxRepeatLength{16};
+
+	/**
+	 * @param source Recorded content
+	 * @param bounds Area covered by the recording, as given by `DisplayListRecorder::getBounds()`
+	 */
+	RecordingObject(IDataSourceStream* source, const Rect& bounds) : stream(source), bounds(bounds)
+	{
+	}
+
+	Renderer* createRenderer(const Location& location) const override;
+
+	Rect calculateBounds() const override
+	{
+		return bounds;
+	}
+
+	/* Meta */
+
+	void write(MetaWriter& meta) const override
+	{
+		meta.write("bounds", bounds);
+		if(stream) {
+			meta.write("stream", stream->getName());
+		}
+	}
+
+	std::unique_ptr<IDataSourceStream> stream;
+	Rect bounds;
+};
+
 /**
  * @brief A collection of line and curve drawing operations
  * 
@@ -1202,6 +1686,13 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	/**
+	 * @brief Drawing extent is obtained by reading through the entire drawing stream
+	 *
+	 * If the drawing contains any objects of unknown extent, the result is also unknown.
+	 */
+	Rect calculateBounds() const override;
+
 	IDataSourceStream& getStream() const
 	{
 		return *stream.get();
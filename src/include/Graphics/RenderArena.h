@@ -0,0 +1,169 @@
+/****
+ * RenderArena.h
+ *
+ * Copyright 2021 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the Sming-Graphics Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * @author: May 2021 - mikee47 <mike@sillyhouse.net>
+ *
+ ****/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Graphics
+{
+/**
+ * @brief Stack-based allocator for renderers and transient objects
+ *
+ * Renderers and the objects they create are short-lived and typically released in reverse order,
+ * so a simple bump allocator avoids most of the cost and fragmentation of heap allocation.
+ * Blocks released out of order are reclaimed once everything above them has been released.
+ *
+ * Whilst an arena is selected using `RenderArena::Scope`, `Renderer` instances are allocated from it.
+ * Objects created by renderers for their own use may also be allocated from it using
+ * `new (RenderArena::transient) ...`; all other objects use the heap.
+ * When the arena is full the heap is used instead.
+ */
+class RenderArena
+{
+public:
+	/**
+	 * @brief Tag used to allocate a transient object from the current arena
+	 */
+	enum Transient { transient };
+
+	/**
+	 * @brief Selects an arena for the lifetime of this object
+	 */
+	class Scope
+	{
+	public:
+		Scope(RenderArena& arena) : previous(current)
+		{
+			current = &arena;
+		}
+
+		~Scope()
+		{
+			current = previous;
+		}
+
+	private:
+		RenderArena* previous;
+	};
+
+	/**
+	 * @brief Constructor
+	 * @param size Capacity in bytes, up to 64K
+	 */
+	RenderArena(size_t size);
+
+	~RenderArena();
+
+	/**
+	 * @brief Allocate a block from this arena
+	 * @retval void* nullptr if there is insufficient space
+	 */
+	void* allocate(size_t size);
+
+	/**
+	 * @brief Release a block allocated from this arena
+	 */
+	void release(void* ptr);
+
+	/**
+	 * @brief Determine whether a block was allocated from this arena
+	 */
+	bool contains(const void* ptr) const
+	{
+		auto p = static_cast<const uint8_t*>(ptr);
+		return p >= buffer.get() && p < buffer.get() + capacity;
+	}
+
+	bool isEmpty() const
+	{
+		return top == 0;
+	}
+
+	/**
+	 * @brief Start a new frame, clearing statistics
+	 *
+	 * All blocks must have been released.
+	 */
+	void reset();
+
+	size_t getCapacity() const
+	{
+		return capacity;
+	}
+
+	/**
+	 * @brief Get maximum number of bytes in use since last reset
+	 */
+	size_t getPeakUsage() const
+	{
+		return peak;
+	}
+
+	/**
+	 * @brief Get number of allocations since last reset which had to use the heap
+	 */
+	unsigned getOverflowCount() const
+	{
+		return overflowCount;
+	}
+
+	/**
+	 * @brief Allocate from the current arena, or the heap if there isn't one
+	 */
+	static void* alloc(size_t size);
+
+	/**
+	 * @brief Release memory obtained via `alloc()`
+	 */
+	static void free(void* ptr);
+
+private:
+	struct alignas(std::max_align_t) Header {
+		uint16_t prev; ///< Offset of previous block
+		bool released;
+	};
+
+	Header* block(uint16_t offset)
+	{
+		return reinterpret_cast<Header*>(&buffer[offset]);
+	}
+
+#ifdef ARCH_HOST
+	// Host renderers may run on multiple threads
+	static thread_local RenderArena* current; ///< Arena for new allocations
+#else
+	static RenderArena* current; ///< Arena for new allocations
+#endif
+	static RenderArena* first;   ///< All arenas, for locating blocks being released
+
+	RenderArena* next{nullptr};
+	std::unique_ptr<uint8_t[]> buffer;
+	uint16_t capacity;
+	uint16_t top{0};  ///< Offset of first free byte
+	uint16_t last{0}; ///< Offset of most recent block
+	uint16_t peak{0};
+	uint16_t overflowCount{0};
+};
+
+} // namespace Graphics
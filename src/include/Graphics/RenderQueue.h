@@ -23,6 +23,7 @@
 
 #include "Surface.h"
 #include "Renderer.h"
+#include <Services/Profiling/MinMax.h>
 
 namespace Graphics
 {
@@ -41,6 +42,7 @@ public:
 	 * @param target Where to render scenes
 	 * @param bufferSize Size of each allocated surface buffer. Specify 0 to use default.
 	 * @param surfaceCount Number of surfaces to allocate
+	 * @param arenaSize Size of arena used for renderers and transient objects. Specify 0 to use the heap.
 	 *
 	 * Surfaces are created by the target display device.
 	 *
@@ -51,14 +53,20 @@ public:
 	 *
 	 * The RenderQueue owns these surfaces.
 	 */
-	RenderQueue(RenderTarget& target, uint8_t surfaceCount = 2, size_t bufferSize = 0)
-		: MultiRenderer(Location{}), target(target)
+	RenderQueue(RenderTarget& target, uint8_t surfaceCount = 2, size_t bufferSize = 0, size_t arenaSize = 2048)
+		: MultiRenderer(Location{}), target(target), arena(arenaSize)
 	{
 		while(surfaceCount-- != 0) {
 			surfaces.add(target.createSurface(bufferSize));
 		}
 	}
 
+	~RenderQueue()
+	{
+		// Renderer may have been allocated from our arena
+		cancel();
+	}
+
 	/**
 	 * @brief Add object to the render queue and start rendering if it isn't already
 	 * @param object Scene, Drawing, etc. to render
@@ -82,10 +90,71 @@ public:
 		return !queue.isEmpty();
 	}
 
+	/**
+	 * @brief Enable tiled rendering for scenes
+	 * @param size Dimensions of each tile, or empty to disable tiling
+	 *
+	 * Each tile is composited in RAM and written to the display in one operation.
+	 * This avoids reading back display memory for blended objects, at the cost of a tile buffer.
+	 * Tile buffer is limited to 32767 bytes, so 64x64 is a reasonable maximum for RGB565.
+	 */
+	void setTileSize(Size size)
+	{
+		tileSize = size;
+	}
+
+	Size getTileSize() const
+	{
+		return tileSize;
+	}
+
+	/**
+	 * @brief Set the time budget for each render slice
+	 * @param us Time in microseconds, 0 for no limit
+	 *
+	 * Rendering runs from the task queue. When the budget is used up the current surface is presented
+	 * and control returned to the system, resuming when a surface becomes available again.
+	 * Renderers check the budget at safe points so a slice may overrun by the time taken for one step.
+	 */
+	void setTimeSlice(uint32_t us)
+	{
+		timeSlice = us;
+	}
+
+	uint32_t getTimeSlice() const
+	{
+		return timeSlice;
+	}
+
+	/**
+	 * @brief Get statistics for time spent in each render slice, in microseconds
+	 */
+	const Profiling::MinMax32& getSliceStats() const
+	{
+		return sliceStats;
+	}
+
+	void resetSliceStats()
+	{
+		sliceStats.clear();
+	}
+
+	/**
+	 * @brief Get the arena used for renderer allocations
+	 *
+	 * Check usage statistics to tune the arena size.
+	 * Statistics are reset when each render starts.
+	 */
+	const RenderArena& getArena() const
+	{
+		return arena;
+	}
+
 private:
 	void renderObject(Object* object, const Location& location, Completed callback, uint16_t delayMs);
 	void renderDone(const Object* object) override;
 	const Object* getNextObject() override;
+	bool startRender(Surface& surface, const Object& object, std::unique_ptr<Renderer>& renderer) override;
 
 	// A queued object plus callback information
 	class Item : public LinkedObjectTemplate<Item>
@@ -93,12 +162,12 @@ private:
 	public:
 		using OwnedList = OwnedLinkedObjectListTemplate<Item>;
 
-		Item(const Object& object, const Location& location, Completed callback, uint16_t delayMs)
+		Item(Object& object, const Location& location, Completed callback, uint16_t delayMs)
 			: object(object), location(location), callback(callback), delayMs(delayMs)
 		{
 		}
 
-		const Object& object;
+		Object& object; ///< Not const as scene damage is cleared when rendering starts
 		Location location;
 		Completed callback;
 		uint16_t delayMs;
@@ -107,10 +176,15 @@ private:
 	void run();
 
 	RenderTarget& target;
+	RenderArena arena;
 	Item::OwnedList queue;
 	std::unique_ptr<Item> item;  ///< Item being rendered
 	Surface::OwnedList surfaces; ///< Available for writing
 	Surface::OwnedList active;   ///< Locked - in transit
+	Size tileSize{};             ///< Tiled scene rendering if non-empty
+	OneShotFastUs sliceTimer;
+	Profiling::MinMax32 sliceStats{"Render slice"};
+	uint32_t timeSlice{50000}; ///< Render budget in microseconds
 	bool done{false};
 };
 
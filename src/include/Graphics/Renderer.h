@@ -69,7 +69,15 @@ public:
 		return count != 0;
 	}
 
-private:
+	/**
+	 * @brief Get number of items which may still be added
+	 */
+	uint8_t available() const
+	{
+		return capacity - count;
+	}
+
+protected:
 	std::unique_ptr<T[]> items;
 	uint8_t capacity;
 	uint8_t count{0};
@@ -115,22 +123,21 @@ private:
 
 /**
  * @brief Small list of rectangles, similar to PointList
+ *
+ * Filled shapes generate many horizontal spans. Those of equal width which are vertically
+ * adjacent to a pending rectangle are merged with it, so callers should add as many rectangles
+ * as capacity allows before rendering. This reduces the number of fill operations required.
  */
 class RectList : public ItemList<Rect>
 {
 public:
-	RectList(const Rect& bounds, const Brush& brush, uint8_t capacity)
+	RectList(const Rect& bounds, const Brush& brush, uint8_t capacity, const Blend* blender = nullptr)
 		: ItemList(capacity), bounds(bounds), object(brush, {})
 	{
+		object.blender = blender;
 	}
 
-	void add(const Rect& rect)
-	{
-		auto r = intersect(rect, bounds.size());
-		if(r) {
-			ItemList::add(r);
-		}
-	}
+	void add(const Rect& rect);
 
 	bool render(Surface& surface);
 
@@ -140,6 +147,64 @@ private:
 	std::unique_ptr<Renderer> renderer;
 };
 
+/**
+ * @brief Row segments with per-pixel coverage, used for anti-aliasing
+ *
+ * Pixels are accumulated into short horizontal runs. Each run is read back once,
+ * the brush colour blended in using pixel coverage as alpha, then written out again.
+ */
+class CoverageList
+{
+public:
+	static constexpr uint8_t maxSegments{8};
+	static constexpr uint8_t maxPixels{32};
+
+	CoverageList(const Rect& bounds, const Brush& brush) : bounds(bounds), brush(brush)
+	{
+	}
+
+	/**
+	 * @brief Add a pixel
+	 * @param pt Location relative to bounds
+	 * @param alpha Coverage, 0 (none) to 255 (full)
+	 *
+	 * Pixels must be added in horizontal order to join an existing segment.
+	 * Check there is at least one segment available first.
+	 */
+	void add(Point pt, uint8_t alpha);
+
+	/**
+	 * @brief Get number of segments which may still be added
+	 */
+	uint8_t available() const
+	{
+		return maxSegments - count;
+	}
+
+	bool render(Surface& surface);
+
+private:
+	struct Segment : public ReadStatusBuffer {
+		Rect r;
+		uint8_t alpha[maxPixels];
+		bool blended;
+
+		Segment() : ReadStatusBuffer{PixelFormat::None, maxPixels * Surface::READ_PIXEL_SIZE}
+		{
+		}
+	};
+
+	void blend(Segment& segment);
+
+	Rect bounds;
+	Brush brush;
+	PackedColor color{};
+	Segment segments[maxSegments];
+	uint8_t count{0};
+	uint8_t readIndex{0};
+	uint8_t writeIndex{0};
+};
+
 /**
  * @brief Base class to render multiple objects
  */
@@ -154,6 +219,26 @@ protected:
 	virtual void renderDone(const Object* object) = 0;
 	virtual const Object* getNextObject() = 0;
 
+	/**
+	 * @brief Start rendering an object
+	 * @retval bool false if surface is full
+	 *
+	 * Override to provide an alternative renderer for particular objects.
+	 */
+	virtual bool startRender(Surface& surface, const Object& object, std::unique_ptr<Renderer>& renderer)
+	{
+		return surface.render(object, location.dest, renderer);
+	}
+
+	/**
+	 * @brief Abandon any render in progress
+	 */
+	void cancel()
+	{
+		renderer.reset();
+		object = nullptr;
+	}
+
 private:
 	std::unique_ptr<Renderer> renderer;
 	const Object* object{nullptr};
@@ -164,32 +249,104 @@ private:
  *
  * Rendering is performed by calling `Surface::render()`. Surfaces are provided by devices so may be able
  * to provide optimised renderers for their hardware.
+ *
+ * Before drawing, objects completely hidden by later opaque fills or images are culled.
+ * Filled rectangles also have any hidden edges trimmed.
+ *
+ * If the scene has recorded damage then only those areas are redrawn.
+ * Plain filled rectangles are clipped to each damaged area.
+ * Other objects cannot be clipped so the damaged area is first extended to include
+ * any such object which it touches, then those objects are drawn in full.
+ * Damage is copied when the renderer is constructed, so the scene may be invalidated again while it's drawn.
  */
 class SceneRenderer : public MultiRenderer
 {
 public:
-	SceneRenderer(const Location& location, const SceneObject& scene) : MultiRenderer(location), scene(scene)
+	SceneRenderer(const Location& location, const SceneObject& scene) : SceneRenderer(location, scene, scene.damage)
 	{
 	}
 
+	/**
+	 * @param location
+	 * @param scene
+	 * @param damage Areas to redraw, empty to draw everything
+	 */
+	SceneRenderer(const Location& location, const SceneObject& scene, const DamageList& damage);
+
 protected:
 	void renderDone(const Object*) override
 	{
 	}
 
-	const Object* getNextObject() override
+	const Object* getNextObject() override;
+
+private:
+	static bool isClippable(const Object& object)
 	{
-		if(nextObject) {
-			nextObject = nextObject->getNext();
-		} else {
-			nextObject = scene.objects.head();
-		}
-		return nextObject;
+		return object.kind() == Object::Kind::FilledRect && static_cast<const FilledRectObject&>(object).radius == 0;
 	}
 
-private:
+	void init();
+
 	const SceneObject& scene;
 	const Object* nextObject{};
+	std::unique_ptr<Rect[]> bounds; ///< Area to draw for each object, empty if hidden
+	DamageList damage;
+	const FilledRectObject* clipSource{};
+	FilledRectObject clipObject{Brush{}, Rect{}};
+	uint16_t objectIndex{0};
+	uint8_t clipIndex{0};
+	bool initialised{false};
+};
+
+/**
+ * @brief Renders a scene in tiles, compositing each one in RAM before writing it to the display
+ *
+ * Each object is drawn into every tile it touches, so blended content reads back from the tile buffer
+ * rather than display memory. Completed tiles are sent using a single `writeDataBuffer` call.
+ *
+ * A tile is only read back from the display if it isn't completely covered by an opaque fill.
+ *
+ * Scenes containing objects which operate on display memory (copy, scroll, surface) are drawn
+ * using a regular SceneRenderer, as is any scene where the tile buffer cannot be allocated.
+ */
+class TiledSceneRenderer : public Renderer
+{
+public:
+	TiledSceneRenderer(const Location& location, const SceneObject& scene, Size tileSize)
+		: Renderer(location), scene(scene), damage(scene.damage), tileSize(tileSize)
+	{
+	}
+
+	bool execute(Surface& surface) override;
+
+private:
+	enum class State {
+		init,
+		nextTile,
+		draw,
+		write,
+		done,
+	};
+
+	bool init(Surface& surface);
+	bool nextTile();
+
+	const SceneObject& scene;
+	DamageList damage;              ///< Copied from scene when rendering starts
+	Size tileSize;
+	Rect area;                      ///< Area of scene to be drawn
+	Rect tile;                      ///< Current tile, relative to scene
+	std::unique_ptr<Rect[]> bounds; ///< Cached bounds for each scene object
+	std::unique_ptr<MemoryImageObject> image;
+	std::unique_ptr<Surface> tileSurface;
+	std::unique_ptr<Renderer> renderer;     ///< Display operations, i.e. readback
+	std::unique_ptr<Renderer> tileRenderer; ///< Drawing into tile
+	SharedBuffer writeBuffer;
+	const Object* object{};
+	uint16_t objectIndex{0};
+	PixelFormat pixelFormat{};
+	State state{};
 };
 
 /**
@@ -289,6 +446,32 @@ private:
 	Mode mode{};
 };
 
+/**
+ * @brief Draws an anti-aliased line using Xiaolin Wu's algorithm
+ *
+ * Only supports solid pens of width 1.
+ */
+class AntialiasedLineRenderer : public Renderer
+{
+public:
+	AntialiasedLineRenderer(const Location& location, const Pen& pen, Point pt1, Point pt2);
+
+	bool execute(Surface& surface) override;
+
+private:
+	void plot(int16_t x, int16_t y, uint8_t alpha)
+	{
+		pixels.add(steep ? Point(y, x) : Point(x, y), alpha);
+	}
+
+	CoverageList pixels;
+	int32_t y;	  ///< Minor axis position, 16.16 fixed-point
+	int32_t dy;	  ///< Change in minor axis position per step
+	int16_t x;	  ///< Major axis position
+	int16_t xend; ///< Final major axis position
+	bool steep;	  ///< Major axis is Y
+};
+
 /**
  * @brief Draws series of lines defined by a `PolylineObject`
  */
@@ -308,6 +491,70 @@ protected:
 	uint16_t index{0};
 };
 
+/**
+ * @brief Draws a filled polygon using a scanline edge table
+ *
+ * Edges are sorted by starting row and stepped in 16.16 fixed-point.
+ * Each scanline is output as one or more horizontal spans, adjacent spans being merged.
+ */
+class FilledPolygonRenderer : public Renderer
+{
+public:
+	FilledPolygonRenderer(const Location& location, const FilledPolygonObject& object);
+
+	bool execute(Surface& surface) override;
+
+protected:
+	FilledPolygonRenderer(const Location& location, const Brush& brush)
+		: Renderer(location), rectangles(location.dest, brush, 8)
+	{
+	}
+
+	/**
+	 * @brief Build the edge table
+	 * @param vertices Polygon outline in 24.8 fixed-point
+	 * @param count Number of vertices
+	 *
+	 * A scanline covers pixels from the left edge to the right edge inclusive,
+	 * rounding to the nearest pixel.
+	 */
+	void init(const IntPoint* vertices, unsigned count);
+
+private:
+	struct Edge {
+		int32_t x;  ///< Current x position, 16.16 fixed-point
+		int32_t dx; ///< Change in x per scanline
+		int16_t y1; ///< First scanline
+		int16_t y2; ///< Scanline following the last one
+	};
+
+	void nextRow();
+
+	RectList rectangles;
+	std::unique_ptr<Edge[]> edges;   ///< All edges, sorted by y1
+	std::unique_ptr<Edge*[]> active; ///< Active edges, sorted by x
+	std::unique_ptr<int16_t[]> spans;
+	uint16_t edgeCount{0};
+	uint16_t nextEdge{0};
+	uint16_t activeCount{0};
+	uint16_t spanCount{0};
+	uint16_t spanIndex{0};
+	int16_t y{0};
+	int16_t ymax{0};
+};
+
+/**
+ * @brief Draws a line wider than one pixel as a filled polygon
+ *
+ * The outline, including any end caps, is built as a single polygon so each scanline
+ * is filled by a single span instead of many small rectangles.
+ */
+class ThickLineRenderer : public FilledPolygonRenderer
+{
+public:
+	ThickLineRenderer(const Location& location, const Pen& pen, Point pt1, Point pt2, LineCap cap);
+};
+
 /**
  * @brief Draws a rectangle as a polyline
  */
@@ -428,32 +675,6 @@ private:
 	Point corners[4];
 };
 
-/**
- * @brief Draws a filled rectangle with rounded corners
- *
- * Code based on https://github.com/adafruit/Adafruit-GFX-Library
- */
-class FilledRoundedRectRenderer : public Renderer
-{
-public:
-	FilledRoundedRectRenderer(const Location& location, const FilledRectObject& object)
-		: Renderer(location), object(object)
-	{
-		auto& rect = this->object.rect;
-		auto r = object.radius;
-		corners[0] = Point(rect.x + r, rect.y + r);
-		corners[1] = Point(rect.x + r, rect.bottom() - r);
-	}
-
-	bool execute(Surface& surface) override;
-
-private:
-	std::unique_ptr<Renderer> renderer;
-	FilledRectObject object;
-	uint8_t state{0};
-	Point corners[2];
-};
-
 /**
  * @brief Draws a circle outline
  * 
@@ -503,7 +724,7 @@ class FilledCircleRenderer : public Renderer
 {
 public:
 	FilledCircleRenderer(const Location& location, const FilledCircleObject& object)
-		: FilledCircleRenderer(location, object.brush, object.centre, object.radius, 0, 0x03)
+		: FilledCircleRenderer(location, object.brush, object.centre, object.radius, Size{}, 0x03)
 	{
 		addLine(x0 - x, x0 + x, y0);
 	}
@@ -511,17 +732,19 @@ public:
 	/**
 	 * @brief Used to draw rounded parts of a rounded rectangle
 	 * These are handled by drawing lines between the left/right corners
+	 * @param delta Offset applied to right-hand side and bottom quadrant
+	 * @param blender Optional blender applied to all filled lines
 	 */
-	FilledCircleRenderer(const Location& location, const Brush& brush, Point centre, uint16_t radius, uint16_t delta,
-						 uint8_t quadrants)
-		: Renderer(location), rectangles(location.dest, brush, 4), x0(centre.x), y0(centre.y), f(1 - radius),
+	FilledCircleRenderer(const Location& location, const Brush& brush, Point centre, uint16_t radius, Size delta,
+						 uint8_t quadrants, const Blend* blender = nullptr)
+		: Renderer(location), rectangles(location.dest, brush, 16, blender), x0(centre.x), y0(centre.y), f(1 - radius),
 		  ddF_x(-2 * radius), ddF_y(1), x(radius), y(0), px(x), py(y), delta(delta), quadrants(quadrants)
 	{
 	}
 
 	bool execute(Surface& surface) override;
 
-private:
+protected:
 	void addLine(uint16_t x0, uint16_t x1, uint16_t y)
 	{
 		rectangles.add(Rect(x0, y, 1 + x1 - x0, 1));
@@ -537,11 +760,35 @@ private:
 	int16_t y;
 	int16_t px;
 	int16_t py;
-	uint16_t delta;
+	Size delta;
 	uint8_t quadrants;
 	Location loc;
 };
 
+/**
+ * @brief Draws a filled rectangle with rounded corners
+ *
+ * Code based on https://github.com/adafruit/Adafruit-GFX-Library
+ */
+class FilledRoundedRectRenderer : public FilledCircleRenderer
+{
+public:
+	FilledRoundedRectRenderer(const Location& location, const FilledRectObject& object)
+		: FilledCircleRenderer(location, object.brush, object.rect.topLeft() + Point(object.radius, object.radius),
+							   object.radius,
+							   Size(object.rect.w - 2 * (object.radius + 1), object.rect.h - 2 * object.radius - 1),
+							   0x03, object.blender)
+	{
+		/*
+		 * Central rectangle. Corner lines are one pixel narrower than this (as in the original code)
+		 * so are drawn separately.
+		 */
+		auto& rect = object.rect;
+		auto r = object.radius;
+		rectangles.add(Rect(rect.x, rect.y + r, rect.w, rect.h - 2 * r));
+	}
+};
+
 /**
  * @brief State information for tracing an ellipse outline
  */
@@ -653,7 +900,7 @@ class FilledEllipseRenderer : public Renderer
 {
 public:
 	FilledEllipseRenderer(const Location& location, const Brush& brush, const Rect& rect)
-		: Renderer(location), r(rect), rectangles(location.dest, brush, 4)
+		: Renderer(location), r(rect), rectangles(location.dest, brush, 16)
 	{
 	}
 
@@ -688,6 +935,38 @@ protected:
 	State state{};
 };
 
+/**
+ * @brief Draws an anti-aliased ellipse or circle outline using pixel coverage
+ *
+ * Each quadrant is drawn in two regions, stepping along whichever axis changes fastest.
+ * Only supports solid pens of width 1.
+ */
+class AntialiasedEllipseRenderer : public Renderer
+{
+public:
+	AntialiasedEllipseRenderer(const Location& location, const Pen& pen, const Rect& rect);
+
+	AntialiasedEllipseRenderer(const Location& location, const CircleObject& object)
+		: AntialiasedEllipseRenderer(location, object.pen, object.getBounds())
+	{
+	}
+
+	bool execute(Surface& surface) override;
+
+private:
+	void step();
+
+	CoverageList pixels;
+	Point centre;
+	uint16_t a;		 ///< Horizontal radius
+	uint16_t b;		 ///< Vertical radius
+	uint16_t limit;	 ///< Last step in current region
+	uint16_t i{0};	 ///< Current step
+	uint8_t dx;		 ///< Offset of right half, for even widths
+	uint8_t dy;		 ///< Offset of bottom half, for even heights
+	uint8_t pass{0}; ///< Quadrant and region
+};
+
 /**
  * @brief Render arc outline with adjustable line width
  */
@@ -746,6 +1025,8 @@ private:
 
 /**
  * @brief Render an image object
+ *
+ * Images with per-pixel alpha are drawn using ImageCopyRenderer.
  */
 class ImageRenderer : public Renderer
 {
@@ -842,6 +1123,12 @@ private:
 	TPoint<int8_t> shift{};
 };
 
+/**
+ * @brief Draw an image by compositing it with existing surface content
+ *
+ * Each line is read back from the surface and the image combined with it using
+ * any per-pixel alpha then the given blend.
+ */
 class ImageCopyRenderer : public CopyRenderer
 {
 public:
@@ -857,6 +1144,8 @@ protected:
 	void readComplete(uint8_t* data, size_t length) override;
 
 private:
+	void blendLine(const Location& loc, uint8_t* data);
+
 	const ImageObject& image;
 	const Blend* blend;
 };
@@ -903,6 +1192,38 @@ private:
 	uint8_t state{0};
 };
 
+/**
+ * @brief Play back recorded display output
+ *
+ * Recorded content is streamed straight into the surface, offset by the render location.
+ * Unrecognised or truncated data ends playback.
+ */
+class RecordingRenderer : public Renderer
+{
+public:
+	RecordingRenderer(const Location& location, const RecordingObject& object) : Renderer(location), object(object)
+	{
+	}
+
+	bool execute(Surface& surface) override;
+
+private:
+	bool readEntry();
+	bool read(void* data, uint16_t length);
+	bool readVar(uint16_t& value);
+
+	const RecordingObject& object;
+	Rect window;			 ///< Address window being assembled from setColumn/setRow
+	uint16_t datalen{0};	 ///< Bytes remaining for current write, or length of repeated data
+	uint16_t repeats{0};	 ///< Number of times to repeat data
+	uint8_t buffer[64];		 ///< Read-ahead for stream
+	uint8_t bufpos{0};		 ///< Read position in buffer
+	uint8_t buflen{0};		 ///< Number of bytes in buffer
+	uint8_t bytesPerPixel{0};
+	bool windowPending{false};
+	uint8_t pattern[RecordingObject::maxRepeatLength]; ///< Data for block fill
+};
+
 /**
  * @brief Perform blending with draw
  */
@@ -59,6 +59,11 @@ public:
 
 	Renderer* createRenderer(const Location& location) const override;
 
+	Rect calculateBounds() const override
+	{
+		return Rect(size);
+	}
+
 	/**
 	 * @brief Add a new object to the scene
 	 * @param obj This will be owned by the scene
@@ -97,7 +102,9 @@ public:
 	void reset(Size size)
 	{
 		objects.clear();
+		damage.clear();
 		this->size = size;
+		invalidateBounds();
 	}
 
 	/**
@@ -106,9 +113,37 @@ public:
 	void clear(const Brush& brush = Color::Black)
 	{
 		objects.clear();
+		damage.clear();
 		fillRect(brush, size);
 	}
 
+	/**
+	 * @brief Mark an area of the scene as requiring redraw
+	 *
+	 * When damage has been recorded only those areas are drawn, and objects which lie
+	 * entirely outside them are skipped. With no damage recorded the entire scene is drawn.
+	 *
+	 * Damage is cleared by the RenderQueue when it starts rendering the scene.
+	 * Areas invalidated while the scene is being rendered are drawn the next time it's queued.
+	 */
+	void invalidate(const Rect& rect)
+	{
+		damage.add(intersect(rect, size));
+	}
+
+	/**
+	 * @brief Mark the area covered by an object as requiring redraw
+	 *
+	 * Call this before and after changing an object so both old and new positions are updated.
+	 * The object's cached bounds are refreshed on each call.
+	 */
+	void invalidate(const Object& object)
+	{
+		object.invalidateBounds();
+		auto r = object.getBounds();
+		invalidate(r ? r : Rect(size));
+	}
+
 	template <typename... ParamTypes> FilledRectObject* fillRect(ParamTypes... params)
 	{
 		return addObject(new FilledRectObject(params...));
@@ -149,6 +184,22 @@ public:
 		return addObject(new PolylineObject(params...));
 	}
 
+	template <typename... ParamTypes> FilledPolygonObject* fillPolygon(ParamTypes... params)
+	{
+		return addObject(new FilledPolygonObject(params...));
+	}
+
+	FilledPolygonObject* fillTriangle(const Brush& brush, Point pt1, Point pt2, Point pt3)
+	{
+		return fillPolygon(brush, pt1, pt2, pt3);
+	}
+
+	FilledPolygonObject* fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+									  Color color)
+	{
+		return fillTriangle(color, Point(x0, y0), Point(x1, y1), Point(x2, y2));
+	}
+
 	template <typename... ParamTypes> CircleObject* drawCircle(ParamTypes... params)
 	{
 		return addObject(new CircleObject(params...));
@@ -228,7 +279,8 @@ public:
 	Size size;
 	CString name;
 	OwnedList objects;
-	AssetList assets; // Not drawn directly, but may be referred to
+	AssetList assets;  // Not drawn directly, but may be referred to
+	DamageList damage; // Areas to be redrawn, empty to redraw everything
 };
 
 } // namespace Graphics
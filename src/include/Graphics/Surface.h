@@ -23,6 +23,7 @@
 
 #include "Object.h"
 #include "Buffer.h"
+#include <Platform/Timers.h>
 
 namespace Graphics
 {
@@ -177,6 +178,35 @@ public:
 	 */
 	virtual bool present(PresentCallback callback = nullptr, void* param = nullptr) = 0;
 
+	/**
+	 * @brief Set timer used to limit time spent rendering into this surface
+	 * @param timer Renderers should yield when this expires, nullptr for no limit
+	 */
+	void setRenderDeadline(OneShotFastUs* timer)
+	{
+		renderDeadline = timer;
+	}
+
+	/**
+	 * @brief Determine whether a render deadline has been set
+	 */
+	bool hasRenderDeadline() const
+	{
+		return renderDeadline != nullptr;
+	}
+
+	/**
+	 * @brief Determine whether renderers should yield at the next safe point
+	 *
+	 * Long-running renderers should check this after making some progress,
+	 * returning false from `Renderer::execute()` if set.
+	 * The surface is then presented and rendering resumes in a later time slice.
+	 */
+	bool yieldRequired() const
+	{
+		return renderDeadline != nullptr && renderDeadline->expired();
+	}
+
 	uint16_t width() const
 	{
 		return getSize().w;
@@ -213,6 +243,9 @@ public:
 	 * @brief Draw a simple vertical line using a filled rectangle
 	 */
 	bool drawVLine(PackedColor color, uint16_t x, uint16_t y0, uint16_t y1, uint16_t w);
+
+private:
+	OneShotFastUs* renderDeadline{nullptr};
 };
 
 } // namespace Graphics
@@ -89,6 +89,15 @@ enum class Origin {
 	BottomRight = SE,
 };
 
+/**
+ * @brief How the ends of lines wider than one pixel are drawn
+ */
+enum class LineCap {
+	None,   ///< Line hangs below and to the right of the end points
+	Square, ///< Line is centred and extends beyond the end points by half its width
+	Round,  ///< Line is centred with semi-circular ends
+};
+
 /**
  * @brief Get the origin for the opposite side of the rectangle
  * 
@@ -483,6 +492,19 @@ struct Rect {
 		return pt.x >= left() && pt.x <= right() && pt.y >= top() && pt.y <= bottom();
 	}
 
+	bool contains(const Rect& r) const
+	{
+		return r.left() >= left() && r.right() <= right() && r.top() >= top() && r.bottom() <= bottom();
+	}
+
+	/**
+	 * @brief Number of pixels enclosed by this rectangle
+	 */
+	uint32_t area() const
+	{
+		return uint32_t(w) * h;
+	}
+
 	int16_t clipX(int16_t x) const
 	{
 		if(x < left()) {
@@ -677,6 +699,79 @@ inline Region operator-(const Region& rgn, const Rect& r)
 	return rgn2;
 }
 
+/**
+ * @brief Tracks areas of a scene which require redrawing
+ *
+ * Rectangles are kept disjoint so that blended content is never drawn twice.
+ * Overlapping rectangles, or those sharing a complete edge, are merged as they're added.
+ * When the list is full the new area is merged with whichever rectangle wastes the fewest pixels.
+ */
+class DamageList
+{
+public:
+	static constexpr uint8_t maxRects{8};
+
+	/**
+	 * @brief Add a rectangle to the damaged area
+	 */
+	void add(const Rect& rect);
+
+	DamageList& operator+=(const Rect& rect)
+	{
+		add(rect);
+		return *this;
+	}
+
+	/**
+	 * @brief Determine if any part of a rectangle is damaged
+	 */
+	bool intersects(const Rect& rect) const;
+
+	/**
+	 * @brief Determine if a rectangle lies entirely within a single damaged area
+	 */
+	bool contains(const Rect& rect) const;
+
+	Rect bounds() const;
+
+	void clear()
+	{
+		count = 0;
+	}
+
+	uint8_t size() const
+	{
+		return count;
+	}
+
+	const Rect& operator[](unsigned index) const
+	{
+		assert(index < count);
+		return rects[index];
+	}
+
+	const Rect* begin() const
+	{
+		return rects;
+	}
+
+	const Rect* end() const
+	{
+		return &rects[count];
+	}
+
+	explicit operator bool() const
+	{
+		return count != 0;
+	}
+
+	String toString() const;
+
+private:
+	Rect rects[maxRects];
+	uint8_t count{0};
+};
+
 /**
  * @brief Identifies position within bounding rectangle
  */
@@ -871,6 +966,7 @@ uint16_t normaliseAngle(int angle);
 String toString(Graphics::Orientation orientation);
 String toString(Graphics::Align align);
 String toString(Graphics::Origin origin);
+String toString(Graphics::LineCap cap);
 String toString(Graphics::FontStyle style);
 
 template <typename T> inline String toString(Graphics::TPoint<T> pt)
@@ -110,12 +110,19 @@ struct __attribute__((packed)) FontResource {
 };
 
 struct ImageResource {
+	enum class Flag {
+		alpha,		   ///< Pixels have an alpha channel
+		premultiplied, ///< Colour channels are pre-multiplied by alpha
+	};
+	using Flags = BitSet<uint8_t, Flag, 2>;
+
 	const FSTR::String* name;
 	uint32_t bmOffset;
 	uint32_t bmSize;
 	uint16_t width;
 	uint16_t height;
 	PixelFormat format;
+	Flags flags;
 
 	Size getSize() const
 	{
@@ -126,6 +133,11 @@ struct ImageResource {
 	{
 		return FSTR::readValue(&format);
 	}
+
+	Flags getFlags() const
+	{
+		return FSTR::readValue(&flags);
+	}
 };
 
 } // namespace Resource
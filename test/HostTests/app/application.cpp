@@ -0,0 +1,28 @@
+#include <SmingTest.h>
+#include <modules.h>
+
+#define XX(t) extern void REGISTER_TEST(t);
+TEST_MAP(XX)
+#undef XX
+
+namespace
+{
+void registerTests()
+{
+#define XX(t)                                                                                                          \
+	REGISTER_TEST(t);                                                                                                  \
+	debug_i("Test '" #t "' registered");
+	TEST_MAP(XX)
+#undef XX
+}
+
+} // namespace
+
+void init()
+{
+	Serial.begin(SERIAL_BAUD_RATE);
+	Serial.systemDebugOutput(true);
+
+	registerTests();
+	System.onReady(SmingTest::runner);
+}
@@ -0,0 +1,6 @@
+COMPONENT_INCDIRS := include
+COMPONENT_SRCDIRS := app modules
+COMPONENT_DEPENDS := SmingTest
+ARDUINO_LIBRARIES := Graphics
+DISABLE_NETWORK := 1
+ENABLE_VIRTUAL_SCREEN := 0
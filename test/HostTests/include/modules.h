@@ -0,0 +1,10 @@
+#pragma once
+
+// List of test modules to register
+#define TEST_MAP(XX)                                                                                                   \
+	XX(Renderer)                                                                                                       \
+	XX(DisplayList)                                                                                                    \
+	XX(NullDevice)                                                                                                     \
+	XX(ParallelRenderer)                                                                                               \
+	XX(Blend)                                                                                                          \
+	XX(Colors)
@@ -0,0 +1,223 @@
+#include <SmingTest.h>
+#include <Graphics/Blend.h>
+
+using namespace Graphics;
+
+namespace
+{
+// Guard bytes either side of the data being blended
+constexpr size_t guardSize{8};
+constexpr size_t maxLength{128};
+
+// Deterministic content so failures are reproducible
+void fillPseudoRandom(uint8_t* buffer, size_t length, uint32_t seed)
+{
+	for(size_t i = 0; i < length; ++i) {
+		seed = seed * 1103515245 + 12345;
+		buffer[i] = seed >> 16;
+	}
+}
+
+/*
+ * Scalar reference: blend one pixel at a time
+ */
+void blendReference(PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t count, uint8_t alpha)
+{
+	auto bpp = getBytesPerPixel(format);
+	for(size_t i = 0; i < count; ++i, srcptr += bpp, dstptr += bpp) {
+		if(format == PixelFormat::RGB565) {
+			uint16_t src = (srcptr[0] << 8) | srcptr[1];
+			uint16_t dst = (dstptr[0] << 8) | dstptr[1];
+			dst = BlendAlpha::blendRGB565(src, dst, alpha);
+			dstptr[0] = dst >> 8;
+			dstptr[1] = dst;
+			continue;
+		}
+		// Alpha byte of BGRA32 is left unchanged
+		for(unsigned c = 0; c < std::min(bpp, uint8_t(3)); ++c) {
+			dstptr[c] = BlendAlpha::blendChannel(srcptr[c], dstptr[c], alpha);
+		}
+	}
+}
+
+enum class BitOp { Xor, XNor, Mask };
+
+uint8_t applyReference(BitOp op, uint8_t dst, uint8_t src)
+{
+	switch(op) {
+	case BitOp::Xor:
+		return dst ^ src;
+	case BitOp::XNor:
+		return ~(dst ^ src);
+	case BitOp::Mask:
+	default:
+		return dst & src;
+	}
+}
+
+void applyBlend(BitOp op, PixelFormat format, PackedColor src, uint8_t* dstptr, size_t length)
+{
+	switch(op) {
+	case BitOp::Xor:
+		return BlendXor::blend(format, src, dstptr, length);
+	case BitOp::XNor:
+		return BlendXNor::blend(format, src, dstptr, length);
+	case BitOp::Mask:
+		return BlendMask::blend(format, src, dstptr, length);
+	}
+}
+
+void applyBlend(BitOp op, PixelFormat format, const uint8_t* srcptr, uint8_t* dstptr, size_t length)
+{
+	switch(op) {
+	case BitOp::Xor:
+		return BlendXor::blend(format, srcptr, dstptr, length);
+	case BitOp::XNor:
+		return BlendXNor::blend(format, srcptr, dstptr, length);
+	case BitOp::Mask:
+		return BlendMask::blend(format, srcptr, dstptr, length);
+	}
+}
+
+} // namespace
+
+class BlendTest : public TestGroup
+{
+public:
+	BlendTest() : TestGroup(_F("Blend"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Alpha kernels")
+		{
+			const PixelFormat formats[]{PixelFormat::RGB565, PixelFormat::RGB24, PixelFormat::BGRA32};
+			const uint8_t alphas[]{1, 77, 128, 200, 254};
+			unsigned mismatches{0};
+			for(auto format : formats) {
+				auto bpp = getBytesPerPixel(format);
+				for(auto alpha : alphas) {
+					// Pixel counts which aren't a multiple of any kernel block size
+					for(unsigned count = 1; count <= maxLength / 4; count += 3) {
+						if(!checkAlphaColor(format, alpha, count * bpp)) {
+							++mismatches;
+						}
+						if(!checkAlphaBuffer(format, alpha, count * bpp)) {
+							++mismatches;
+						}
+					}
+				}
+			}
+			REQUIRE_EQ(mismatches, 0U);
+		}
+
+		TEST_CASE("Bitwise blends")
+		{
+			const PixelFormat formats[]{PixelFormat::RGB565, PixelFormat::RGB24, PixelFormat::BGRA32};
+			const BitOp ops[]{BitOp::Xor, BitOp::XNor, BitOp::Mask};
+			unsigned mismatches{0};
+			for(auto op : ops) {
+				for(auto format : formats) {
+					// Every alignment relative to a 64-bit word, with odd lengths to leave partial words
+					for(unsigned offset = 0; offset < 8; ++offset) {
+						for(unsigned length = 1; length < maxLength - 8; length += 6) {
+							if(!checkBitwise(op, format, offset, length)) {
+								++mismatches;
+							}
+						}
+					}
+				}
+			}
+			REQUIRE_EQ(mismatches, 0U);
+		}
+	}
+
+private:
+	/*
+	 * Blend a fixed colour and compare with the scalar reference
+	 */
+	bool checkAlphaColor(PixelFormat format, uint8_t alpha, size_t length)
+	{
+		auto bpp = getBytesPerPixel(format);
+		PackedColor src{};
+		fillPseudoRandom(reinterpret_cast<uint8_t*>(&src), sizeof(src), length);
+		src.alpha = alpha;
+
+		uint8_t srcBuffer[maxLength];
+		for(size_t i = 0; i < length; ++i) {
+			srcBuffer[i] = reinterpret_cast<const uint8_t*>(&src)[i % bpp];
+		}
+
+		uint8_t expected[maxLength + 2 * guardSize];
+		fillPseudoRandom(expected, sizeof(expected), alpha + length);
+		uint8_t actual[sizeof(expected)];
+		memcpy(actual, expected, sizeof(actual));
+
+		blendReference(format, srcBuffer, &expected[guardSize], length / bpp, alpha);
+		BlendAlpha::blend(format, src, &actual[guardSize], length);
+		return memcmp(expected, actual, sizeof(expected)) == 0;
+	}
+
+	/*
+	 * Blend source pixels and compare with the scalar reference
+	 */
+	bool checkAlphaBuffer(PixelFormat format, uint8_t alpha, size_t length)
+	{
+		uint8_t srcBuffer[maxLength];
+		fillPseudoRandom(srcBuffer, length, length);
+
+		uint8_t expected[maxLength + 2 * guardSize];
+		fillPseudoRandom(expected, sizeof(expected), alpha + length);
+		uint8_t actual[sizeof(expected)];
+		memcpy(actual, expected, sizeof(actual));
+
+		blendReference(format, srcBuffer, &expected[guardSize], length / getBytesPerPixel(format), alpha);
+		BlendAlpha::blend(format, srcBuffer, &actual[guardSize], length, alpha);
+		return memcmp(expected, actual, sizeof(expected)) == 0;
+	}
+
+	/*
+	 * Apply a bitwise blend at the given offset from an aligned buffer and compare with a byte-wise loop
+	 */
+	bool checkBitwise(BitOp op, PixelFormat format, unsigned offset, size_t length)
+	{
+		auto bpp = getBytesPerPixel(format);
+		PackedColor src{};
+		fillPseudoRandom(reinterpret_cast<uint8_t*>(&src), sizeof(src), offset + length);
+
+		uint8_t srcBuffer[maxLength];
+		fillPseudoRandom(srcBuffer, length, length);
+
+		alignas(8) uint8_t initial[maxLength + 2 * guardSize];
+		fillPseudoRandom(initial, sizeof(initial), offset);
+		alignas(8) uint8_t expected[sizeof(initial)];
+		alignas(8) uint8_t actual[sizeof(initial)];
+		auto dst = guardSize + offset;
+
+		// Fixed colour: pattern starts with the first byte of the colour at dstptr
+		memcpy(expected, initial, sizeof(initial));
+		for(size_t i = 0; i < length; ++i) {
+			expected[dst + i] = applyReference(op, expected[dst + i], reinterpret_cast<uint8_t*>(&src)[i % bpp]);
+		}
+		memcpy(actual, initial, sizeof(initial));
+		applyBlend(op, format, src, &actual[dst], length);
+		if(memcmp(expected, actual, sizeof(expected)) != 0) {
+			return false;
+		}
+
+		// Source buffer
+		memcpy(expected, initial, sizeof(initial));
+		for(size_t i = 0; i < length; ++i) {
+			expected[dst + i] = applyReference(op, expected[dst + i], srcBuffer[i]);
+		}
+		memcpy(actual, initial, sizeof(initial));
+		applyBlend(op, format, srcBuffer, &actual[dst], length);
+		return memcmp(expected, actual, sizeof(expected)) == 0;
+	}
+};
+
+void REGISTER_TEST(Blend)
+{
+	registerGroup<BlendTest>();
+}
@@ -0,0 +1,110 @@
+#include <SmingTest.h>
+#include <Graphics/Colors.h>
+
+using namespace Graphics;
+
+namespace
+{
+constexpr size_t maxPixels{37};
+
+/*
+ * Generic conversion one pixel at a time, as used for formats without a specialised converter
+ */
+void convertReference(const uint8_t* srcptr, PixelFormat srcFormat, uint8_t* dstptr, PixelFormat dstFormat,
+					  size_t numPixels)
+{
+	auto srcBytes = getBytesPerPixel(srcFormat);
+	auto dstBytes = getBytesPerPixel(dstFormat);
+	for(size_t i = 0; i < numPixels; ++i, srcptr += srcBytes, dstptr += dstBytes) {
+		PixelBuffer buf{};
+		memcpy(&buf, srcptr, srcBytes);
+		buf = pack(unpack(buf, srcFormat), dstFormat);
+		memcpy(dstptr, &buf, dstBytes);
+	}
+}
+
+} // namespace
+
+class ColorsTest : public TestGroup
+{
+public:
+	ColorsTest() : TestGroup(_F("Colors"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Pixel converters")
+		{
+			const PixelFormat formats[]{PixelFormat::RGB24, PixelFormat::BGRA32, PixelFormat::BGR24,
+										PixelFormat::RGB565};
+			const size_t pixelCounts[]{1, 2, 5, maxPixels};
+			unsigned mismatches{0};
+			for(auto srcFormat : formats) {
+				for(auto dstFormat : formats) {
+					for(auto numPixels : pixelCounts) {
+						if(!checkConverter(srcFormat, dstFormat, numPixels, false)) {
+							++mismatches;
+						}
+						if(!checkConverter(srcFormat, dstFormat, numPixels, true)) {
+							++mismatches;
+						}
+					}
+				}
+			}
+			REQUIRE_EQ(mismatches, 0U);
+		}
+	}
+
+private:
+	/*
+	 * Compare converter with the generic conversion, optionally converting in place.
+	 * Guard bytes after the output check nothing else is written.
+	 */
+	bool checkConverter(PixelFormat srcFormat, PixelFormat dstFormat, size_t numPixels, bool inPlace)
+	{
+		constexpr size_t bufSize{maxPixels * 4 + 8};
+		auto srcBytes = getBytesPerPixel(srcFormat);
+		auto dstBytes = getBytesPerPixel(dstFormat);
+
+		uint8_t src[bufSize];
+		uint32_t seed = numPixels;
+		for(auto& c : src) {
+			seed = seed * 1103515245 + 12345;
+			c = seed >> 16;
+		}
+
+		uint8_t expected[bufSize];
+		memset(expected, 0xa5, sizeof(expected));
+		convertReference(src, srcFormat, expected, dstFormat, numPixels);
+
+		uint8_t actual[bufSize];
+		memset(actual, 0xa5, sizeof(actual));
+		const void* srcData = src;
+		if(inPlace) {
+			memcpy(actual, src, numPixels * srcBytes);
+			srcData = actual;
+		}
+		auto converter = getConverter(srcFormat, dstFormat);
+		auto length = converter(srcData, actual, numPixels);
+		if(length != numPixels * dstBytes) {
+			return false;
+		}
+		if(inPlace) {
+			// Unused source bytes beyond the output are left as they were
+			auto used = std::max(srcBytes, dstBytes) * numPixels;
+			memcpy(&expected[length], &src[length], used - length);
+		}
+		if(memcmp(expected, actual, sizeof(expected)) != 0) {
+			debug_e("Mismatch %s -> %s, %u pixels%s", toString(srcFormat).c_str(), toString(dstFormat).c_str(),
+					unsigned(numPixels), inPlace ? " in place" : "");
+			return false;
+		}
+		return true;
+	}
+};
+
+void REGISTER_TEST(Colors)
+{
+	registerGroup<ColorsTest>();
+}
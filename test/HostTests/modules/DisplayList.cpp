@@ -0,0 +1,163 @@
+#include <SmingTest.h>
+#include <Graphics/SpiDisplayList.h>
+#include <Graphics/Renderer.h>
+#include <Data/Stream/MemoryDataStream.h>
+
+using namespace Graphics;
+
+namespace
+{
+const SpiDisplayList::Commands commands{
+	.setColumn = 0x2a,
+	.setRow = 0x2b,
+	.readStart = 0x2e,
+	.read = 0x3e,
+	.writeStart = 0x2c,
+};
+
+/*
+ * Build pixel data with runs of the given lengths, separated by single distinct pixels
+ */
+std::vector<uint8_t> createRuns(uint8_t bytesPerPixel, std::initializer_list<unsigned> runs)
+{
+	std::vector<uint8_t> data;
+	unsigned index{0};
+	auto addPixel = [&]() {
+		for(unsigned i = 0; i < bytesPerPixel; ++i) {
+			data.push_back(index * 37 + i * 91 + 1);
+		}
+	};
+	for(auto run : runs) {
+		for(unsigned i = 0; i < run; ++i) {
+			addPixel();
+		}
+		++index;
+		addPixel();
+		++index;
+	}
+	return data;
+}
+
+/*
+ * Expand list into SPI requests and return the pixel data written
+ */
+std::vector<uint8_t> expand(SpiDisplayList& list)
+{
+	std::vector<uint8_t> output;
+	bool writing{false};
+	list.prepare(nullptr, nullptr);
+	while(list.fillRequest()) {
+		auto& req = list.request;
+		if(req.cmdLen != 0) {
+			writing = (req.cmd == commands.writeStart);
+		}
+		if(writing) {
+			auto data = static_cast<const uint8_t*>(req.out.get());
+			output.insert(output.end(), data, data + req.out.length);
+		}
+	}
+	return output;
+}
+
+} // namespace
+
+class DisplayListTest : public TestGroup
+{
+public:
+	DisplayListTest() : TestGroup(_F("DisplayList"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Recording bounds")
+		{
+			AddressWindow addrWindow;
+			DisplayList list(addrWindow, 256);
+			uint16_t color{0x1234};
+
+			// Second window differs only in x so just setColumn is emitted
+			REQUIRE(list.setAddrWindow(Rect(10, 5, 20, 8)));
+			REQUIRE(list.blockFill(&color, sizeof(color), 20 * 8));
+			REQUIRE(list.setAddrWindow(Rect(40, 5, 20, 8)));
+			REQUIRE(list.blockFill(&color, sizeof(color), 20 * 8));
+
+			MemoryDataStream stream;
+			DisplayListRecorder recorder(stream);
+			REQUIRE(recorder.record(list, Point(2, 1)));
+			REQUIRE(recorder.getBounds() == Rect(8, 4, 50, 8));
+		}
+
+		TEST_CASE("Recording long repeat")
+		{
+			constexpr Size size{10, 4};
+			// More data than playback buffers for a repeat
+			uint8_t pattern[size.w * 2];
+			for(unsigned i = 0; i < sizeof(pattern); ++i) {
+				pattern[i] = i * 13 + 7;
+			}
+			static_assert(sizeof(pattern) > RecordingObject::maxRepeatLength, "Pattern too short");
+
+			AddressWindow addrWindow;
+			DisplayList list(addrWindow, 256);
+			REQUIRE(list.setAddrWindow(Rect(size)));
+			REQUIRE(list.blockFill(pattern, sizeof(pattern), size.h));
+
+			auto stream = new MemoryDataStream;
+			DisplayListRecorder recorder(*stream);
+			REQUIRE(recorder.record(list, Point{}));
+			RecordingObject recording(stream, recorder.getBounds());
+
+			MemoryImageObject image(PixelFormat::RGB565, size);
+			REQUIRE(image.isValid());
+			std::unique_ptr<Surface> surface(image.createSurface());
+			std::unique_ptr<Renderer> renderer;
+			REQUIRE(surface->render(recording, Rect(size), renderer));
+			while(!surface->execute(renderer)) {
+				// Memory surfaces never block
+			}
+
+			uint8_t line[sizeof(pattern)];
+			Location loc;
+			for(loc.pos.y = 0; loc.pos.y < size.h; ++loc.pos.y) {
+				image.readPixels(loc, PixelFormat::RGB565, line, size.w);
+				REQUIRE(memcmp(line, pattern, sizeof(pattern)) == 0);
+			}
+		}
+
+		TEST_CASE("Run-length encoding round trip")
+		{
+			for(uint8_t bpp = 2; bpp <= 4; ++bpp) {
+				for(uint8_t minRepeats : {1, 3, 8}) {
+					// Shortest run which gets encoded, see DisplayList::getMinRunLength()
+					unsigned threshold = std::max(minRepeats * bpp, 7 + bpp);
+					threshold = (threshold + bpp - 1) / bpp;
+					auto input = createRuns(bpp, {threshold, 1, threshold - 1, threshold + 1, 200, 2, threshold});
+					// Finish with a run
+					input.resize(input.size() - bpp);
+
+					AddressWindow addrWindow;
+					SpiDisplayList list(commands, addrWindow, 1024);
+					list.setRunLengthEncoding(bpp, minRepeats);
+					REQUIRE(list.setAddrWindow(Rect(0, 0, 100, 100)));
+					uint16_t available;
+					auto buffer = list.getBuffer(input.size(), available);
+					REQUIRE(buffer != nullptr);
+					memcpy(buffer, input.data(), input.size());
+					list.commit(input.size());
+					// Long run must have been encoded
+					REQUIRE(list.used() < input.size());
+
+					auto output = expand(list);
+					REQUIRE_EQ(output.size(), input.size());
+					REQUIRE(output == input);
+				}
+			}
+		}
+	}
+};
+
+void REGISTER_TEST(DisplayList)
+{
+	registerGroup<DisplayListTest>();
+}
@@ -0,0 +1,86 @@
+#include <SmingTest.h>
+#include <Graphics/Display/Null.h>
+
+using namespace Graphics;
+
+class NullDeviceTest : public TestGroup
+{
+public:
+	NullDeviceTest() : TestGroup(_F("NullDevice"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Bus model frame time")
+		{
+			Display::NullDevice device;
+			device.enableBusModel();
+			REQUIRE_EQ(device.getRunLengthEncoding(), 0);
+			std::unique_ptr<Surface> surface(device.createSurface());
+			REQUIRE(surface);
+
+			uint16_t color{0x1234};
+			REQUIRE(surface->setAddrWindow(Rect(0, 0, 10, 10)));
+			REQUIRE(surface->blockFill(&color, sizeof(color), 100));
+			REQUIRE(surface->present([](void*) {}, nullptr));
+
+			auto stats = device.snapshotBusStats();
+			/*
+			 * CASET + data, RASET + data, RAMWR, one 64-byte repeat block then three more:
+			 * 100 pixels * 2 bytes = 200 = 8 + 3 * 64
+			 */
+			REQUIRE_EQ(stats.requests, 9U);
+			REQUIRE_EQ(stats.commands, 3U);
+			REQUIRE_EQ(stats.windowChanges, 2U);
+			REQUIRE_EQ(stats.bytesOut, 208U);
+			// At 40MHz each bit takes 25ns
+			REQUIRE_EQ(stats.commandTime, 3U * 8 * 25);
+			REQUIRE_EQ(stats.addressTime, 8U * 8 * 25);
+			REQUIRE_EQ(stats.writeTime, 200U * 8 * 25);
+			REQUIRE_EQ(stats.readTime, 0U);
+			REQUIRE_EQ(stats.overheadTime, 9U * 1000);
+			REQUIRE_EQ(stats.getBusTime(), 51200U);
+			// 40000 / 51200
+			REQUIRE_EQ(stats.getPixelDataShare(), 78U);
+		}
+
+		TEST_CASE("Bus model run-length encoding")
+		{
+			// Identical pixels written as data are only encoded as a repeat if enabled
+			auto writeRun = [this](uint8_t minRepeats) {
+				Display::NullDevice device;
+				device.enableBusModel();
+				device.setRunLengthEncoding(minRepeats);
+				std::unique_ptr<Surface> surface(device.createSurface());
+				REQUIRE(surface->setAddrWindow(Rect(0, 0, 10, 10)));
+				uint16_t available;
+				auto buffer = surface->getBuffer(200, available);
+				REQUIRE(buffer != nullptr);
+				for(unsigned i = 0; i < 200; i += 2) {
+					buffer[i] = 0x34;
+					buffer[i + 1] = 0x12;
+				}
+				surface->commit(200);
+				REQUIRE(surface->present([](void*) {}, nullptr));
+				return device.snapshotBusStats();
+			};
+
+			auto stats = writeRun(0);
+			REQUIRE_EQ(stats.requests, 6U);
+			REQUIRE_EQ(stats.bytesOut, 208U);
+			REQUIRE_EQ(stats.writeTime, 200U * 8 * 25);
+
+			// Same pixel data on the bus, but expanding the repeat takes more transactions
+			stats = writeRun(4);
+			REQUIRE_EQ(stats.requests, 9U);
+			REQUIRE_EQ(stats.bytesOut, 208U);
+			REQUIRE_EQ(stats.writeTime, 200U * 8 * 25);
+		}
+	}
+};
+
+void REGISTER_TEST(NullDevice)
+{
+	registerGroup<NullDeviceTest>();
+}
@@ -0,0 +1,76 @@
+#include <SmingTest.h>
+#include <Graphics/Renderer.h>
+#ifdef ARCH_HOST
+#include <Graphics/ParallelSceneRenderer.h>
+#endif
+
+using namespace Graphics;
+
+class ParallelRendererTest : public TestGroup
+{
+public:
+	ParallelRendererTest() : TestGroup(_F("ParallelRenderer"))
+	{
+	}
+
+	void execute() override
+	{
+#ifdef ARCH_HOST
+		TEST_CASE("Compare with SceneRenderer")
+		{
+			constexpr Size size{64, 48};
+			SceneObject scene(size);
+			// Opaque background, so bands need no readback from the target
+			scene.clear();
+			scene.fillRect(Color::Red, Rect(4, 4, 30, 20), 5);
+			scene.drawRect(Pen(Color::Yellow, 2), Rect(20, 10, 40, 30), 3);
+			scene.fillCircle(Color::Blue, Point(40, 24), 15);
+			scene.drawCircle(Color::White, Point(10, 38), 8);
+			scene.fillEllipse(Color::Green, Rect(30, 30, 30, 16));
+			scene.drawLine(Pen(Color::Cyan, 3), Point(0, 47), Point(63, 0));
+			scene.fillArc(Color::Magenta, Rect(0, 0, 40, 40), 30, 200);
+			scene.fillPolygon(Brush(Color::Orange), Point(50, 2), Point(62, 20), Point(44, 14));
+
+			MemoryImageObject expected(PixelFormat::RGB565, size);
+			MemoryImageObject actual(PixelFormat::RGB565, size);
+			REQUIRE(expected.isValid() && actual.isValid());
+
+			SceneRenderer sceneRenderer(Location{size}, scene);
+			renderSync(expected, sceneRenderer);
+
+			// More bands than CPUs, some only a few lines high
+			ParallelSceneRenderer parallelRenderer(Location{size}, scene, 7);
+			renderSync(actual, parallelRenderer);
+
+			unsigned mismatches{0};
+			Location loc;
+			for(loc.pos.y = 0; loc.pos.y < size.h; ++loc.pos.y) {
+				uint16_t expectedLine[size.w];
+				uint16_t actualLine[size.w];
+				expected.readPixels(loc, PixelFormat::RGB565, expectedLine, size.w);
+				actual.readPixels(loc, PixelFormat::RGB565, actualLine, size.w);
+				for(unsigned x = 0; x < size.w; ++x) {
+					if(actualLine[x] != expectedLine[x]) {
+						++mismatches;
+					}
+				}
+			}
+			REQUIRE_EQ(mismatches, 0U);
+		}
+#endif
+	}
+
+private:
+	void renderSync(MemoryImageObject& image, Renderer& renderer)
+	{
+		std::unique_ptr<Surface> surface(image.createSurface());
+		while(!renderer.execute(*surface)) {
+			// Renderer is yielding
+		}
+	}
+};
+
+void REGISTER_TEST(ParallelRenderer)
+{
+	registerGroup<ParallelRendererTest>();
+}
@@ -0,0 +1,241 @@
+#include <SmingTest.h>
+#include <Graphics/RenderQueue.h>
+#include <Graphics/Control/Control.h>
+
+using namespace Graphics;
+
+namespace
+{
+constexpr Size imageSize{40, 30};
+
+/*
+ * Controls draw into a scene owned by their renderer, after it's been constructed
+ */
+class TestControl : public Control
+{
+public:
+	using Control::Control;
+
+	void draw(SceneObject& scene) const override
+	{
+		scene.fillRect(Color::Red, bounds);
+		scene.fillRect(Color::Blue, Rect(bounds.topLeft() + Point(2, 2), 4, 4));
+		// Objects created during rendering may outlive it
+		persistent.reset(new FilledRectObject(Color::Green, bounds));
+	}
+
+	mutable std::unique_ptr<Object> persistent;
+};
+
+/*
+ * Invalidates part of another scene when drawn, as an application might in response to an event
+ */
+class InvalidatingControl : public Control
+{
+public:
+	InvalidatingControl(const Rect& bounds, SceneObject& target, const Rect& area)
+		: Control(bounds), target(target), area(area)
+	{
+	}
+
+	void draw(SceneObject& scene) const override
+	{
+		scene.fillRect(Color::Green, bounds);
+		target.invalidate(area);
+	}
+
+private:
+	SceneObject& target;
+	Rect area;
+};
+
+/*
+ * Image with every third column opaque white, the rest fully transparent
+ */
+class StripedImage : public ImageObject
+{
+public:
+	using ImageObject::ImageObject;
+
+	bool init() override
+	{
+		return true;
+	}
+
+	PixelFormat getPixelFormat() const override
+	{
+		return PixelFormat::None;
+	}
+
+	AlphaMode getAlphaMode() const override
+	{
+		return AlphaMode::straight;
+	}
+
+	size_t readPixels(const Location& loc, PixelFormat format, void* buffer, uint16_t width) const override
+	{
+		std::unique_ptr<uint8_t[]> alpha(new uint8_t[width]);
+		return readAlphaPixels(loc, format, buffer, alpha.get(), width);
+	}
+
+	size_t readAlphaPixels(const Location& loc, PixelFormat format, void* buffer, uint8_t* alpha,
+						   uint16_t width) const override
+	{
+		auto bufptr = static_cast<uint8_t*>(buffer);
+		auto x = loc.sourcePos().x;
+		for(unsigned i = 0; i < width; ++i, ++x) {
+			alpha[i] = (x % 3) ? 0 : 0xff;
+			bufptr += writeColor(bufptr, Color::White, format);
+		}
+		return bufptr - static_cast<uint8_t*>(buffer);
+	}
+};
+
+uint16_t rgb565(Color color)
+{
+	return pack(color, PixelFormat::RGB565).value;
+}
+
+} // namespace
+
+class RendererTest : public TestGroup
+{
+public:
+	RendererTest()
+		: TestGroup(_F("Renderer")), image(PixelFormat::RGB565, imageSize), renderQueue(image),
+		  control(Rect(10, 10, 20, 10))
+	{
+	}
+
+	void execute() override
+	{
+		REQUIRE(image.isValid());
+		controlTest();
+		pending();
+	}
+
+	void controlTest()
+	{
+		Serial.println(_F("Control"));
+		auto scene = createScene();
+		scene->drawObject(control, scene->getSize());
+		render(scene, [this]() {
+			REQUIRE_EQ(getPixel(5, 5), rgb565(Color::Black));
+			REQUIRE_EQ(getPixel(10, 10), rgb565(Color::Red));
+			REQUIRE_EQ(getPixel(13, 13), rgb565(Color::Blue));
+			REQUIRE(control.persistent);
+			REQUIRE(!renderQueue.getArena().contains(control.persistent.get()));
+			control.persistent.reset();
+			copyTest();
+		});
+	}
+
+	/*
+	 * Objects read by a copy must be drawn even if they're covered later
+	 */
+	void copyTest()
+	{
+		Serial.println(_F("Copy, then cover source"));
+		auto scene = createScene();
+		scene->fillRect(Color::Green, Rect(0, 0, 10, 10));
+		scene->copy(Rect(0, 0, 10, 10), Point(20, 0));
+		scene->fillRect(Color::Red, Rect(0, 0, 10, 10));
+		render(scene, [this]() {
+			REQUIRE_EQ(getPixel(25, 5), rgb565(Color::Green));
+			REQUIRE_EQ(getPixel(5, 5), rgb565(Color::Red));
+			polygonTest();
+		});
+	}
+
+	/*
+	 * Concave polygon with a downward spike whose tip is above the bottom of the polygon
+	 */
+	void polygonTest()
+	{
+		Serial.println(_F("Concave polygon"));
+		auto scene = createScene();
+		scene->fillPolygon(Brush(Color::White), Point(2, 2), Point(6, 12), Point(10, 6), Point(14, 20), Point(18, 2));
+		render(scene, [this]() {
+			REQUIRE_EQ(getPixel(6, 12), rgb565(Color::White));
+			REQUIRE_EQ(getPixel(6, 13), rgb565(Color::Black));
+			REQUIRE_EQ(getPixel(10, 6), rgb565(Color::White));
+			REQUIRE_EQ(getPixel(10, 5), rgb565(Color::White));
+			REQUIRE_EQ(getPixel(10, 8), rgb565(Color::Black));
+			REQUIRE_EQ(getPixel(14, 20), rgb565(Color::White));
+			alphaImageTest();
+		});
+	}
+
+	/*
+	 * Alpha images are blended in chunks, so check columns in each chunk line up with the image
+	 */
+	void alphaImageTest()
+	{
+		Serial.println(_F("Alpha image"));
+		auto scene = createScene();
+		scene->addObject(new StripedImage(imageSize));
+		render(scene, [this]() {
+			for(uint16_t x = 0; x < imageSize.w; ++x) {
+				REQUIRE_EQ(getPixel(x, 5), rgb565((x % 3) ? Color::Black : Color::White));
+			}
+			damageTest();
+		});
+	}
+
+	/*
+	 * Damage recorded while a scene is being rendered must be kept for the next frame
+	 */
+	void damageTest()
+	{
+		Serial.println(_F("Invalidate during render"));
+		auto scene = createScene();
+		Rect controlArea(10, 10, 20, 10);
+		Rect lateArea(0, 0, 5, 5);
+		auto control = new InvalidatingControl(controlArea, *scene, lateArea);
+		scene->addObject(control);
+		scene->invalidate(controlArea);
+		renderQueue.render(scene, [this, controlArea, lateArea](SceneObject* scene) {
+			REQUIRE_EQ(getPixel(15, 15), rgb565(Color::Green));
+			REQUIRE(scene->damage.intersects(lateArea));
+			REQUIRE(!scene->damage.intersects(controlArea));
+			delete scene;
+			complete();
+		});
+	}
+
+private:
+	using Check = Delegate<void()>;
+
+	SceneObject* createScene()
+	{
+		auto scene = new SceneObject(imageSize);
+		scene->clear();
+		return scene;
+	}
+
+	void render(SceneObject* scene, Check check)
+	{
+		renderQueue.render(scene, [check](SceneObject* scene) {
+			delete scene;
+			check();
+		});
+	}
+
+	uint16_t getPixel(int16_t x, int16_t y)
+	{
+		uint16_t color{0};
+		Location loc;
+		loc.pos = Point(x, y);
+		image.readPixels(loc, PixelFormat::RGB565, &color, 1);
+		return color;
+	}
+
+	MemoryImageObject image;
+	RenderQueue renderQueue;
+	TestControl control;
+};
+
+void REGISTER_TEST(Renderer)
+{
+	registerGroup<RendererTest>();
+}